@@ -0,0 +1,801 @@
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+
+@file
+@brief DynamicFormat class and printing.
+*/
+
+#pragma once
+
+#include <ceformat/config.hpp>
+#include <ceformat/String.hpp>
+#include <ceformat/element_defs.hpp>
+#include <ceformat/Format.hpp>
+#include <ceformat/print.hpp>
+#include <ceformat/sink.hpp>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+
+namespace ceformat {
+
+/**
+	@addtogroup format
+	@{
+*/
+
+/**
+	Runtime-parsed format.
+
+	Elements are parsed with the same rules as Format, and invalid
+	format strings throw the same @c std::logic_error. Argument types
+	are checked when printing instead of at compile time.
+
+	@remarks The number of elements is not limited by
+	@c ELEMENTS_MAX, but the format string is limited to 65535
+	characters like Format.
+*/
+class DynamicFormat final {
+public:
+	/** %Format string. */
+	String const string;
+	/** Elements, including the terminating ElementType::end. */
+	std::vector<Element> const elements;
+	/** Number of elements (excluding ElementType::end). */
+	std::size_t const element_count;
+	/** Number of literal elements. */
+	std::size_t const literal_count;
+	/** Number of escape elements. */
+	std::size_t const escape_count;
+	/** Literal text (see Format::literal_char()). */
+	String const literal;
+	/** Literal segments (see Format::segments). */
+	std::vector<Segment> const segments;
+
+private:
+	static std::vector<Element>
+	cons_elements(
+		String const& string
+	);
+
+	static std::size_t
+	cons_count_type(
+		std::vector<Element> const& elements,
+		ElementType const type
+	) noexcept;
+
+	static String
+	cons_literal(
+		String const& string,
+		std::vector<Element> const& elements
+	);
+
+	static std::vector<Segment>
+	cons_segments(
+		std::vector<Element> const& elements
+	);
+
+public:
+	/**
+		Construct with string.
+
+		@remarks This is not cached (see cached()), so it is the
+		entry point for arbitrary format strings.
+
+		@throws std::logic_error If @a string is not a valid format.
+		@param string %Format string.
+	*/
+	explicit
+	DynamicFormat(
+		StringView const string
+	);
+
+	/**
+		Get cached format for string.
+
+		@remarks The cache is keyed by string content and is shared
+		by all threads. Only the first lookup of a string parses it;
+		later lookups neither parse nor allocate. Each thread keeps
+		the formats it has looked up, so repeated lookups take no
+		lock. Cached formats live until the program exits.
+
+		@warning Nothing is ever evicted, so the cache grows with every
+		distinct string. Only pass a bounded set of strings (e.g.,
+		configured templates or a manifest); construct a DynamicFormat
+		directly for arbitrary input.
+
+		@throws std::logic_error If @a string is not a valid format
+		(which is not cached).
+		@returns Format for @a string.
+		@param string %Format string.
+	*/
+	static DynamicFormat const&
+	cached(
+		StringView const string
+	);
+
+	/**
+		Get the specifier character of an element.
+
+		@returns Last character of @a element.
+		@param element Element of this format.
+	*/
+	char
+	spec(
+		Element const& element
+	) const noexcept {
+		return this->string[element.end - 1u];
+	}
+};
+
+/** @cond INTERNAL */
+namespace detail {
+
+// FNV-1a
+struct DynamicFormatHash final {
+	std::size_t
+	operator()(
+		StringView const string
+	) const noexcept {
+		std::uint64_t hash = 0xCBF29CE484222325u;
+		for (std::size_t i = 0u; string.size() > i; ++i) {
+			hash ^= static_cast<unsigned char>(string[i]);
+			hash *= 0x100000001B3u;
+		}
+		return static_cast<std::size_t>(hash);
+	}
+};
+
+struct DynamicFormatCache final {
+	std::mutex mutex;
+	// NB: Keys view the string of their format
+	std::unordered_map<
+		StringView,
+		std::unique_ptr<DynamicFormat const>,
+		DynamicFormatHash
+	> formats;
+};
+
+inline DynamicFormatCache&
+dynamic_format_cache() {
+	static DynamicFormatCache s_cache;
+	return s_cache;
+}
+
+// Formats looked up by this thread; keys view the string of their
+// format, which outlives the thread's cache
+using DynamicFormatFrontCache = std::unordered_map<
+	StringView,
+	DynamicFormat const*,
+	DynamicFormatHash
+>;
+
+inline DynamicFormatFrontCache&
+dynamic_format_front_cache() {
+	static thread_local DynamicFormatFrontCache s_front;
+	return s_front;
+}
+
+} // namespace detail
+/** @endcond */ // INTERNAL
+
+// class DynamicFormat implementation
+
+inline std::vector<Element>
+DynamicFormat::cons_elements(
+	String const& string
+) {
+	if (UINT16_MAX < string.size()) {
+		throw std::logic_error("format string too long");
+	}
+	char const* const data = string.data();
+	std::size_t const size = string.size();
+	std::vector<Element> elements;
+	std::size_t pos = 0u;
+	for (;;) {
+		// NB: The parser would find the element itself, but memchr()
+		// is vectorized
+		void const* const found = std::memchr(
+			data + pos, ELEMENT_CHAR, size - pos
+		);
+		elements.push_back(Element{Element::Parser{
+			data, size, SIZE_MAX, elements.size(),
+			nullptr == found
+				? size
+				: static_cast<std::size_t>(static_cast<char const*>(found) - data)
+		}});
+		if (ElementType::end == elements.back().type) {
+			break;
+		}
+		pos = elements.back().end;
+	}
+	return elements;
+}
+
+inline std::size_t
+DynamicFormat::cons_count_type(
+	std::vector<Element> const& elements,
+	ElementType const type
+) noexcept {
+	std::size_t count = 0u;
+	for (Element const& element : elements) {
+		count += static_cast<std::size_t>(type == element.type);
+	}
+	return count;
+}
+
+inline String
+DynamicFormat::cons_literal(
+	String const& string,
+	std::vector<Element> const& elements
+) {
+	String literal;
+	literal.reserve(string.size());
+	std::size_t pos = 0u;
+	for (Element const& element : elements) {
+		if (ElementType::esc == element.type) {
+			// Keep the first ELEMENT_CHAR of the escape
+			literal.append(string.data() + pos, element.beg + 1u - pos);
+			pos = element.end;
+		}
+	}
+	literal.append(string.data() + pos, string.size() - pos);
+	return literal;
+}
+
+inline std::vector<Segment>
+DynamicFormat::cons_segments(
+	std::vector<Element> const& elements
+) {
+	std::vector<Segment> segments;
+	std::size_t escapes = 0u;
+	std::size_t beg = 0u;
+	for (Element const& element : elements) {
+		if (ElementType::esc == element.type) {
+			++escapes;
+			continue;
+		}
+		segments.push_back(Segment{
+			static_cast<std::uint16_t>(beg),
+			static_cast<std::uint16_t>(element.beg - escapes - beg),
+			element.idx
+		});
+		beg = element.end - escapes;
+	}
+	return segments;
+}
+
+inline
+DynamicFormat::DynamicFormat(
+	StringView const string
+)
+	: string(string.data(), string.size())
+	, elements(cons_elements(this->string))
+	, element_count(this->elements.size() - 1u)
+	, literal_count(
+		this->element_count - cons_count_type(this->elements, ElementType::esc)
+	)
+	, escape_count(this->element_count - this->literal_count)
+	, literal(cons_literal(this->string, this->elements))
+	, segments(cons_segments(this->elements))
+{}
+
+inline DynamicFormat const&
+DynamicFormat::cached(
+	StringView const string
+) {
+	detail::DynamicFormatFrontCache& front = detail::dynamic_format_front_cache();
+	auto const hit = front.find(string);
+	if (front.end() != hit) {
+		return *hit->second;
+	}
+
+	detail::DynamicFormatCache& cache = detail::dynamic_format_cache();
+	DynamicFormat const* shared = nullptr;
+	{
+		std::lock_guard<std::mutex> const lock{cache.mutex};
+		auto const it = cache.formats.find(string);
+		if (cache.formats.end() != it) {
+			shared = it->second.get();
+		}
+	}
+	if (nullptr == shared) {
+		// NB: Parsed without the lock; if another thread cached the
+		// same string meanwhile, its format is kept
+		std::unique_ptr<DynamicFormat const> format{new DynamicFormat(string)};
+		StringView const key{format->string.data(), format->string.size()};
+		std::lock_guard<std::mutex> const lock{cache.mutex};
+		shared = cache.formats.emplace(key, std::move(format)).first->second.get();
+	}
+	front.emplace(StringView{shared->string.data(), shared->string.size()}, shared);
+	return *shared;
+}
+
+/** @} */ // end of doc-group format
+
+/**
+	@addtogroup print
+	@{
+*/
+
+/** @cond INTERNAL */
+namespace {
+
+// Stream with its formatting state restored on destruction
+struct DynamicStateStream final {
+	std::ostream& stream;
+	ios::fmtflags const flags;
+	std::streamsize const width;
+	std::streamsize const precision;
+	char const fill;
+
+	DynamicStateStream(DynamicStateStream const&) = delete;
+	DynamicStateStream& operator=(DynamicStateStream const&) = delete;
+
+	explicit
+	DynamicStateStream(
+		std::ostream& stream
+	)
+		: stream(stream)
+		, flags(stream.flags())
+		, width(stream.width())
+		, precision(stream.precision())
+		, fill(stream.fill())
+	{}
+
+	~DynamicStateStream() {
+		this->stream.flags(this->flags);
+		this->stream.width(this->width);
+		this->stream.precision(this->precision);
+		this->stream.fill(this->fill);
+	}
+};
+
+template<
+	class ArgF,
+	class... ArgP
+>
+struct dynamic_type_check final {
+	static void
+	check(
+		DynamicFormat const& format,
+		std::size_t const index
+	) {
+		if (
+			!detail::type_to_element<ArgF>::valid ||
+			!detail::type_to_element<ArgF>::type_matches(
+				format.elements[format.segments[index].element].type
+			)
+		) {
+			throw std::logic_error("type of argument does not match element");
+		}
+		dynamic_type_check<ArgP...>::check(format, index + 1u);
+	}
+};
+
+template<class ArgF>
+struct dynamic_type_check<ArgF> final {
+	static void
+	check(
+		DynamicFormat const& format,
+		std::size_t const index
+	) {
+		if (
+			!detail::type_to_element<ArgF>::valid ||
+			!detail::type_to_element<ArgF>::type_matches(
+				format.elements[format.segments[index].element].type
+			)
+		) {
+			throw std::logic_error("type of argument does not match element");
+		}
+	}
+};
+
+template<class... ArgP>
+inline typename std::enable_if<0u == sizeof...(ArgP)>::type
+check_dynamic_args(
+	DynamicFormat const& format
+) {
+	if (0u != format.literal_count) {
+		throw std::logic_error("arguments do not match format");
+	}
+}
+
+template<class... ArgP>
+inline typename std::enable_if<0u != sizeof...(ArgP)>::type
+check_dynamic_args(
+	DynamicFormat const& format
+) {
+	if (sizeof...(ArgP) != format.literal_count) {
+		throw std::logic_error("arguments do not match format");
+	}
+	dynamic_type_check<ArgP...>::check(format, 0u);
+}
+
+// NB: Each value's element state is applied in full, since it is not
+// known at compile time which state the previous value left. Object
+// elements reset the flags that affect number formatting, so objects
+// start from the default state.
+template<class Arg>
+inline void
+write_dynamic_element(
+	DynamicStateStream& out,
+	Element const& element,
+	char const spec,
+	Arg&& arg
+) {
+	StreamState const next = element_state(element, spec);
+	if (flag_none != next.mask) {
+		out.stream.setf(next.flags, next.mask);
+	}
+	if ('\0' != next.fill) {
+		out.stream.fill(next.fill);
+	}
+	if (-1 != next.precision) {
+		out.stream.precision(
+			-2 == next.precision
+			? out.precision
+			: next.precision
+		);
+	}
+	if (write_shortest(out.stream, element, spec, arg)) {
+		return;
+	}
+	if (0u != element.width) {
+		out.stream.width(static_cast<std::streamsize>(element.width));
+	}
+	out.stream <<
+		static_cast<typename detail::type_to_element<Arg>::cast>(
+			std::forward<Arg>(arg)
+		)
+	;
+	if (flag_none != (restore_mask & next.mask)) {
+		out.stream.setf(out.flags, restore_mask & next.mask);
+	}
+}
+
+template<
+	class Sink,
+	class Arg
+>
+inline void
+write_dynamic_element(
+	Sink& sink,
+	Element const& element,
+	char const spec,
+	Arg&& arg
+) {
+	detail::write_value(
+		sink,
+		element,
+		spec,
+		static_cast<typename detail::type_to_element<Arg>::cast>(
+			std::forward<Arg>(arg)
+		)
+	);
+}
+
+inline void
+write_literal(
+	DynamicStateStream& out,
+	char const* const data,
+	std::size_t const size
+) {
+	out.stream.write(data, static_cast<std::streamsize>(size));
+}
+
+template<class Out>
+inline void
+write_dynamic_segment(
+	Out& out,
+	DynamicFormat const& format,
+	std::size_t const index
+) {
+	Segment const& segment = format.segments[index];
+	if (0u != segment.size) {
+		write_literal(
+			out,
+			format.literal.data() + segment.beg,
+			segment.size
+		);
+	}
+}
+
+template<class Out>
+inline void
+write_dynamic_impl(
+	Out& out,
+	DynamicFormat const& format,
+	std::size_t const index
+) {
+	write_dynamic_segment(out, format, index);
+}
+
+template<
+	class Out,
+	class ArgF,
+	class... ArgP
+>
+inline void
+write_dynamic_impl(
+	Out& out,
+	DynamicFormat const& format,
+	std::size_t const index,
+	ArgF&& front,
+	ArgP&&... args
+) {
+	write_dynamic_segment(out, format, index);
+	Element const& element = format.elements[format.segments[index].element];
+	write_dynamic_element(
+		out,
+		element,
+		format.spec(element),
+		std::forward<ArgF>(front)
+	);
+	write_dynamic_impl(
+		out,
+		format,
+		index + 1u,
+		std::forward<ArgP>(args)...
+	);
+}
+
+inline std::size_t
+measure_dynamic_impl(
+	DynamicFormat const& format,
+	std::size_t const index
+) noexcept {
+	return format.segments[index].size;
+}
+
+template<
+	class ArgF,
+	class... ArgP
+>
+inline std::size_t
+measure_dynamic_impl(
+	DynamicFormat const& format,
+	std::size_t const index,
+	ArgF&& front,
+	ArgP&&... args
+) {
+	Element const& element = format.elements[format.segments[index].element];
+	return
+		format.segments[index].size
+		+ detail::measure_value(
+			element,
+			format.spec(element),
+			static_cast<typename detail::type_to_element<ArgF>::cast>(
+				std::forward<ArgF>(front)
+			)
+		)
+		+ measure_dynamic_impl(
+			format,
+			index + 1u,
+			std::forward<ArgP>(args)...
+		)
+	;
+}
+
+template<
+	class Sink,
+	class... ArgP
+>
+inline typename std::enable_if<
+	!detail::sink_has_reserve<Sink>::value ||
+	detail::any_object<ArgP...>::value
+>::type
+reserve_dynamic_hint(
+	Sink& /*sink*/,
+	DynamicFormat const& /*format*/,
+	ArgP&&... /*args*/
+) noexcept {}
+
+template<
+	class Sink,
+	class... ArgP
+>
+inline typename std::enable_if<
+	detail::sink_has_reserve<Sink>::value &&
+	!detail::any_object<ArgP...>::value
+>::type
+reserve_dynamic_hint(
+	Sink& sink,
+	DynamicFormat const& format,
+	ArgP&&... args
+) {
+	sink.reserve(measure_dynamic_impl(format, 0u, std::forward<ArgP>(args)...));
+}
+} // anonymous namespace
+/** @endcond */ // INTERNAL
+
+/**
+	Write dynamic format to stream.
+
+	@throws std::logic_error If @a args do not match @a format.
+	@tparam ...ArgP Argument pack.
+	@param stream Stream to write to.
+	@param format %Format.
+	@param args Arguments.
+*/
+template<class... ArgP>
+inline void
+write(
+	std::ostream& stream,
+	DynamicFormat const& format,
+	ArgP&&... args
+) {
+	check_dynamic_args<ArgP...>(format);
+	DynamicStateStream out{stream};
+	write_dynamic_impl(
+		out,
+		format,
+		0u,
+		std::forward<ArgP>(args)...
+	);
+}
+
+/**
+	Write dynamic format to sink.
+
+	@remarks Same as write() to a sink for a Format.
+
+	@throws std::logic_error If @a args do not match @a format.
+	@tparam Sink Sink type (see sink.hpp).
+	@tparam ...ArgP Argument pack.
+	@param sink Sink to write to.
+	@param format %Format.
+	@param args Arguments.
+*/
+template<
+	class Sink,
+	class... ArgP
+>
+inline typename std::enable_if<
+	!std::is_base_of<std::ostream, Sink>::value
+>::type
+write(
+	Sink& sink,
+	DynamicFormat const& format,
+	ArgP&&... args
+) {
+	check_dynamic_args<ArgP...>(format);
+	reserve_dynamic_hint(sink, format, args...);
+	write_dynamic_impl(
+		sink,
+		format,
+		0u,
+		std::forward<ArgP>(args)...
+	);
+}
+
+/**
+	Write dynamic format to character buffer.
+
+	@note Output is truncated at @a last. No null terminator is
+	written.
+
+	@throws std::logic_error If @a args do not match @a format.
+	@returns Same as format_to() for a Format.
+	@tparam ...ArgP Argument pack.
+	@param first Beginning of buffer.
+	@param last End of buffer.
+	@param format %Format.
+	@param args Arguments.
+*/
+template<class... ArgP>
+inline FormatToResult
+format_to(
+	char* const first,
+	char* const last,
+	DynamicFormat const& format,
+	ArgP&&... args
+) {
+	check_dynamic_args<ArgP...>(format);
+	BufferSink sink{first, last, 0u};
+	write_dynamic_impl(
+		sink,
+		format,
+		0u,
+		std::forward<ArgP>(args)...
+	);
+	return FormatToResult{sink.pos, sink.size};
+}
+
+/**
+	Calculate size of formatted output of dynamic format.
+
+	@throws std::logic_error If @a args do not match @a format.
+	@returns Number of characters write() would output for @a args.
+	@tparam ...ArgP Argument pack.
+	@param format %Format.
+	@param args Arguments.
+*/
+template<class... ArgP>
+inline std::size_t
+formatted_size(
+	DynamicFormat const& format,
+	ArgP&&... args
+) {
+	check_dynamic_args<ArgP...>(format);
+	return measure_dynamic_impl(
+		format,
+		0u,
+		std::forward<ArgP>(args)...
+	);
+}
+
+/**
+	Append dynamic format to string.
+
+	@remarks Growth is the same as print_to() for a Format.
+
+	@throws std::logic_error If @a args do not match @a format.
+	@returns @a out.
+	@tparam ...ArgP Argument pack.
+	@param out String to append to.
+	@param format %Format.
+	@param args Arguments.
+*/
+template<class... ArgP>
+inline String&
+print_to(
+	String& out,
+	DynamicFormat const& format,
+	ArgP&&... args
+) {
+	check_dynamic_args<ArgP...>(format);
+	if (detail::any_object<ArgP...>::value) {
+		StringSink sink{out};
+		write_dynamic_impl(
+			sink,
+			format,
+			0u,
+			std::forward<ArgP>(args)...
+		);
+	} else {
+		std::size_t const pos = out.size();
+		out.resize(pos + measure_dynamic_impl(format, 0u, args...));
+		BufferSink sink{&out[0] + pos, &out[0] + out.size(), 0u};
+		write_dynamic_impl(
+			sink,
+			format,
+			0u,
+			std::forward<ArgP>(args)...
+		);
+	}
+	return out;
+}
+
+/**
+	Write dynamic format to string.
+
+	@throws std::logic_error If @a args do not match @a format.
+	@returns Formatted string.
+	@tparam ...ArgP Argument pack.
+	@param format %Format.
+	@param args Arguments.
+*/
+template<class... ArgP>
+inline String
+print(
+	DynamicFormat const& format,
+	ArgP&&... args
+) {
+	String str;
+	print_to(
+		str,
+		format,
+		std::forward<ArgP>(args)...
+	);
+	return str;
+}
+
+/** @} */ // end of doc-group print
+
+} // namespace ceformat
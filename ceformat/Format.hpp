@@ -11,8 +11,10 @@
 #include <ceformat/utility.hpp>
 #include <ceformat/element_defs.hpp>
 #include <ceformat/Particle.hpp>
+#include <ceformat/detail/sequence.hpp>
 
 #include <stdexcept>
+#include <cstdint>
 #include <iomanip>
 #include <ostream>
 #include <sstream>
@@ -21,7 +23,9 @@ namespace ceformat {
 
 // Forward declarations
 class Format;
+class DynamicFormat;
 class Element;
+struct Segment;
 
 /**
 	@addtogroup format
@@ -30,144 +34,209 @@ class Element;
 
 /**
 	%Format element.
+
+	Positions and width are 16-bit, and type, flags and precision are
+	8-bit, so an element occupies 12 bytes.
 */
 class Element final {
 public:
 	friend class Format;
+	friend class DynamicFormat;
 
-	/** %Format. */
-	Format const& fmt;
 	/** %Element index. */
-	std::size_t const idx;
+	std::uint16_t const idx;
 	/** Beginning position. */
-	std::size_t const beg;
+	std::uint16_t const beg;
+	/** Ending position. */
+	std::uint16_t const end;
+	/** Width. */
+	std::uint16_t const width;
 	/** Type. */
 	ElementType const type;
 	/** Flags. */
-	unsigned const flags;
-	/** Width. */
-	std::size_t const width;
+	std::uint8_t const flags;
 	/** Floating-point precision. */
-	signed const precision;
-	/** Ending position. */
-	std::size_t const end;
+	std::int8_t const precision;
 
 private:
-	bool valid_;
+	bool const valid_;
 
-	enum class ctor_invalid {};
+	class Parser;
 
-	enum class NumeralSegment : unsigned {
-		none = 0u,
-		width,
-		precision,
-	};
+	enum class ctor_invalid {};
 
 	constexpr
 	Element(
-		Format const& fmt,
 		std::size_t const index,
+		std::size_t const size,
 		ctor_invalid const
 	) noexcept;
 
 	constexpr
 	Element(
-		Format const& fmt,
+		Parser const& parser
+	);
+
+public:
+	/**
+		Check if element has a flag.
+
+		@returns @c true if the element has @a flag enabled.
+		@param f Flag to test.
+	*/
+	constexpr bool
+	has_flag(
+		ElementFlags const f
+	) const noexcept {
+		return
+		static_cast<unsigned>(f) & this->flags;
+	}
+};
+
+/** @cond INTERNAL */
+// Element parsing state
+class Element::Parser final {
+public:
+	enum class NumeralSegment : unsigned {
+		none = 0u,
+		width,
+		precision,
+	};
+
+	// NB: Errors are latched per field so that the first error of the
+	// earliest field is reported, as if each field were parsed
+	// separately in order.
+	enum class Error : unsigned {
+		none = 0u,
+		expected_precision_numeral,
+		leading_zero,
+		zero_pad_repeated,
+		flag_after_numeral,
+		width_after_flag,
+		precision_after_flag,
+		precision_repeated,
+	};
+
+	struct FlagsState final {
+		bool zero_padded;
+		NumeralSegment segment;
+		bool precision_prelude;
+		unsigned flags;
+		Error error;
+	};
+
+	struct WidthState final {
+		bool done;
+		bool in_width;
+		std::size_t width;
+		Error error;
+	};
+
+	struct PrecisionState final {
+		bool in_precision;
+		signed precision;
+		Error error;
+	};
+
+	// Result of scanning an element; pos is the position of the type
+	struct Scan final {
+		std::size_t pos;
+		ElementType type;
+		FlagsState f;
+		WidthState w;
+		PrecisionState p;
+	};
+
+	char const* const string;
+	std::size_t const size;
+	std::size_t const limit;
+	std::size_t const idx;
+	std::size_t const beg;
+	Scan const scan;
+	ElementType const type;
+	unsigned const flags;
+	std::size_t const width;
+	signed const precision;
+	std::size_t const end;
+	bool const valid_;
+
+	constexpr
+	Parser(
+		char const* const string,
+		std::size_t const size,
+		std::size_t const limit,
 		std::size_t const index,
 		std::size_t const pos
-	) noexcept;
+	);
 
+private:
 	constexpr std::size_t
 	cons_beg(
 		std::size_t const pos
 	) const noexcept;
 
-	constexpr unsigned
-	cons_flags_inner(
+	static constexpr FlagsState
+	next_flags(
+		FlagsState const& s,
 		char const value,
-		Particle const& particle,
-		std::size_t const next,
-		bool const zero_padded,
-		NumeralSegment const segment,
-		bool const precision_prelude,
-		unsigned const c_flags
-	) const noexcept;
-
-	constexpr unsigned
-	cons_flags(
-		std::size_t const pos,
-		bool const zero_padded,
-		NumeralSegment const segment,
-		bool const precision_prelude,
-		unsigned const c_flags
-	) const noexcept;
-
-	constexpr ElementType
-	cons_type_inner(
-		Particle const& particle,
-		std::size_t const next
-	) const noexcept;
-
-	constexpr ElementType
-	cons_type(
-		std::size_t const pos
-	) const noexcept;
-
-	constexpr std::size_t
-	cons_end() const noexcept;
+		Particle const& particle
+	) noexcept;
 
-	constexpr std::size_t
-	cons_width_inner(
+	static constexpr WidthState
+	next_width(
+		WidthState const& s,
 		char const value,
-		Particle const& particle,
-		std::size_t const next,
-		bool const in_width,
-		unsigned const width_accum
-	) const noexcept;
+		Particle const& particle
+	) noexcept;
 
-	constexpr std::size_t
-	cons_width(
-		std::size_t pos,
-		bool const in_width,
-		unsigned const width_accum
-	) const noexcept;
+	static constexpr PrecisionState
+	next_precision(
+		PrecisionState const& s,
+		char const value,
+		Particle const& particle
+	) noexcept;
 
-	constexpr signed
-	cons_precision_inner(
+	constexpr Scan
+	cons_scan_inner(
+		std::size_t const pos,
 		char const value,
 		Particle const& particle,
-		std::size_t const next,
-		bool const in_precision,
-		signed const precision_accum
-	) const noexcept;
+		Scan const& s
+	) const;
 
-	constexpr signed
-	cons_precision(
-		std::size_t pos,
-		bool const in_precision,
-		signed const precision_accum
-	) const noexcept;
+	constexpr Scan
+	cons_scan(
+		std::size_t const pos,
+		Scan const& s
+	) const;
+
+	static constexpr bool
+	error_check(
+		Error const error
+	);
 
 	constexpr bool
 	flag_check() const noexcept;
 
 	constexpr bool
-	valid_check() const noexcept;
+	valid_check() const;
+};
+/** @endcond */
 
-public:
-	/**
-		Check if element has a flag.
+/**
+	Literal segment.
 
-		@returns @c true if the element has @a flag enabled.
-		@param f Flag to test.
-	*/
-	constexpr bool
-	has_flag(
-		ElementFlags const f
-	) const noexcept {
-		return
-		static_cast<unsigned>(f) & this->flags;
-	}
+	A run of literal text preceding a non-escape element. Segments
+	index into the literal text of a format, which is the format
+	string with escapes collapsed (see Format::literal_char()).
+*/
+struct Segment final {
+	/** Beginning position in literal text. */
+	std::uint16_t const beg;
+	/** Size. */
+	std::uint16_t const size;
+	/** Index of the non-escape element following the segment. */
+	std::uint16_t const element;
 };
 
 /**
@@ -185,6 +254,15 @@ public:
 	std::size_t const element_count;
 	/** Number of literal elements. */
 	std::size_t const literal_count;
+	/** Number of escape elements. */
+	std::size_t const escape_count;
+	/**
+		Literal segments.
+
+		There is one segment for each literal element and one for
+		the trailing text (preceding ElementType::end).
+	*/
+	Segment const segments[ELEMENTS_MAX + 1u];
 
 private:
 	constexpr Element
@@ -194,14 +272,13 @@ private:
 		return
 		// Construct all elements past ElementType::end as invalid
 		0u < index && ElementType::end == this->elements[index - 1].type
-			? Element{*this, index, Element::ctor_invalid{}}
+			? Element{index, this->size, Element::ctor_invalid{}}
 
 		// Fill next slot
-		: Element{
-			*this,
-			index,
+		: Element{Element::Parser{
+			this->string, this->size, ELEMENTS_MAX, index,
 			(0u == index) ? 0u : elements[index - 1].end
-		}
+		}}
 		;
 	}
 
@@ -210,54 +287,156 @@ private:
 		std::size_t const c_size = 0u
 	) const noexcept {
 		return false ? 0u
+		// Positions are 16-bit
+		: UINT16_MAX < c_size
+			? throw std::logic_error("format string too long")
+
 		: 0u != c_size
 			? c_size - static_cast<unsigned>('\0' == this->string[c_size - 1])
 		: c_size
 		;
 	}
 
+	// Number of elements of type in [beg, end)
 	constexpr std::size_t
-	cons_count(
-		std::size_t const index = 0u
+	cons_count_type(
+		ElementType const type,
+		std::size_t const beg,
+		std::size_t const end
 	) const noexcept {
 		return false ? 0u
-		: ELEMENTS_MAX + 1u == index
-			? throw std::logic_error("element array overrun")
+		: beg >= end
+			? 0u
 
-		// No more elements to consider
-		: ElementType::end == this->elements[index].type
-			? index
+		: 1u == end - beg
+			? static_cast<std::size_t>(type == this->elements[beg].type)
 
-		// Continue
-		: cons_count(index + 1u)
+		// Split (logarithmic depth)
+		: cons_count_type(type, beg, beg + (end - beg) / 2u)
+		+ cons_count_type(type, beg + (end - beg) / 2u, end)
 		;
 	}
 
+	// Index of the first ElementType::end in [beg, end), or end
+	// (elements past the first ElementType::end are all
+	// ElementType::end)
 	constexpr std::size_t
-	cons_count_literal(
-		std::size_t const count = 0u,
-		std::size_t const index = 0u
+	cons_find_end(
+		std::size_t const beg,
+		std::size_t const end
+	) const noexcept {
+		return false ? 0u
+		: beg >= end
+			? end
+
+		: ElementType::end == this->elements[beg + (end - beg) / 2u].type
+			? cons_find_end(beg, beg + (end - beg) / 2u)
+			: cons_find_end(beg + (end - beg) / 2u + 1u, end)
+		;
+	}
+
+	constexpr std::size_t
+	cons_count(
+		std::size_t const count
 	) const noexcept {
 		return false ? 0u
-		: ELEMENTS_MAX + 1u == index
+		: ELEMENTS_MAX + 1u == count
 			? throw std::logic_error("element array overrun")
 
-		// No more elements to consider
+		: count
+		;
+	}
+
+	constexpr std::size_t
+	cons_value_index(
+		std::size_t const n,
+		std::size_t const index = 0u
+	) const noexcept {
+		return false ? 0u
+		// Terminate at end (value for the trailing segment)
 		: ElementType::end == this->elements[index].type
-			? count
+			? index
+
+		// Escapes are not values
+		: ElementType::esc == this->elements[index].type
+			? cons_value_index(n, index + 1u)
+
+		: 0u == n
+			? index
 
 		// Continue
-		: cons_count_literal(
-			count
-			// esc is not a literal type
-			+ static_cast<std::size_t>(
-				ElementType::esc != this->elements[index].type
+		: cons_value_index(n - 1u, index + 1u)
+		;
+	}
+
+	constexpr std::size_t
+	cons_escapes_before(
+		std::size_t const index
+	) const noexcept {
+		return cons_count_type(ElementType::esc, 0u, index);
+	}
+
+	constexpr Segment
+	cons_segment(
+		std::size_t const pos,
+		std::size_t const escapes,
+		std::size_t const element
+	) const noexcept {
+		return Segment{
+			static_cast<std::uint16_t>(pos - escapes),
+			static_cast<std::uint16_t>(
+				this->elements[element].beg - pos
+				- (cons_escapes_before(element) - escapes)
 			),
-			index + 1u
+			static_cast<std::uint16_t>(element)
+		};
+	}
+
+	constexpr Segment
+	s(
+		std::size_t const n
+	) const noexcept {
+		return
+		// Construct all segments past the trailing segment as empty
+		this->literal_count < n
+			? Segment{
+				static_cast<std::uint16_t>(this->size - this->escape_count),
+				0u,
+				static_cast<std::uint16_t>(this->element_count)
+			}
+
+		: 0u == n
+			? cons_segment(0u, 0u, cons_value_index(0u))
+
+		// Continue from end of previous value
+		: cons_segment(
+			this->elements[cons_value_index(n - 1u)].end,
+			cons_escapes_before(cons_value_index(n - 1u)),
+			cons_value_index(n)
 		)
 		;
 	}
 
+	template<
+		std::size_t... I
+	>
+	constexpr
+	Format(
+		char const* const string,
+		std::size_t const string_size,
+		detail::index_sequence<I...>
+	) noexcept
+		: string(string)
+		, size(cons_size(string_size))
+		, elements{e(I)...}
+		, element_count(cons_count(cons_find_end(0u, ELEMENTS_MAX + 1u)))
+		, literal_count(
+			element_count - cons_count_type(ElementType::esc, 0u, element_count)
+		)
+		, escape_count(element_count - literal_count)
+		, segments{s(I)...}
+	{}
+
 public:
 	/**
 		Construct with C-string.
@@ -272,21 +451,11 @@ public:
 	Format(
 		char const (&string)[N]
 	) noexcept
-		: string(string)
-		, size(cons_size(N))
-		, elements{
-			e(0u ),e(1u ),
-			e(2u ),e(3u ),
-			e(4u ),e(5u ),
-			e(6u ),e(7u ),
-			e(8u ),e(9u ),
-			e(10u),e(11u),
-			e(12u),e(13u),
-			e(14u),e(15u),
-			e(16u)
-		}
-		, element_count(cons_count())
-		, literal_count(cons_count_literal())
+		: Format(
+			string,
+			N,
+			detail::make_index_sequence<ELEMENTS_MAX + 1u>{}
+		)
 	{}
 
 	/**
@@ -305,6 +474,36 @@ public:
 	constexpr Element const*
 	end() const noexcept { return elements + ELEMENTS_MAX; }
 
+	/**
+		Get character of literal text.
+
+		@remarks Literal text is the format string with each escape
+		collapsed to a single @c ELEMENT_CHAR. Its size is
+		<code>size - escape_count</code>.
+
+		@returns Character at @a pos in literal text.
+		@param pos Position in literal text.
+		@param index Element to start searching from.
+	*/
+	constexpr char
+	literal_char(
+		std::size_t const pos,
+		std::size_t const index = 0u
+	) const noexcept {
+		return false ? '\0'
+		// No escapes before pos (includes ElementType::end)
+		: pos <= this->elements[index].beg
+			? this->string[pos]
+
+		// Skip the collapsed character
+		: ElementType::esc == this->elements[index].type
+			? literal_char(pos + 1u, index + 1u)
+
+		// Continue
+		: literal_char(pos, index + 1u)
+		;
+	}
+
 	/**
 		Get the next literal element index.
 
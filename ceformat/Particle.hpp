@@ -80,8 +80,6 @@ struct Particle final {
 
 namespace {
 constexpr Particle const
-s_particle_numeral{Particle::numeral},
-s_particle_precision{Particle::precision},
 s_particles[]{
 	// types
 	{ELEMENT_CHAR, ElementType::esc},
@@ -100,45 +98,55 @@ s_particles[]{
 	// flags
 	{'#', ElementFlags::alternative},
 	{'+', ElementFlags::show_sign},
-	// s_particle_numeral catches this
+	// numeral catches this
 	//{'0', ElementFlags::zero_padded},
 	{'-', ElementFlags::left_align},
-	{Particle::invalid}
+	{Particle::invalid},
+
+	// Numeral could be width or ElementFlags::zero_padded
+	{Particle::numeral},
+	// Precision specifier
+	{Particle::precision}
 };
+
+// Index of the particle for each character in s_particles
+// NB: A string literal is much cheaper to index in a constant
+// expression than an array of class type.
+constexpr char const
+s_particle_index[]
+=
+	"\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F"
+	"\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F"
+	"\x0F\x0F\x0F\x0C\x0F\x00\x0F\x0F\x0F\x0F\x0F\x0D\x0F\x0E\x11\x0F"
+	"\x10\x10\x10\x10\x10\x10\x10\x10\x10\x10\x0F\x0F\x0F\x0F\x0F\x0F"
+	"\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F"
+	"\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F"
+	"\x0F\x0F\x09\x01\x02\x07\x06\x08\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x05"
+	"\x0A\x0F\x0F\x0B\x0F\x03\x0F\x0F\x04\x0F\x0F\x0F\x0F\x0F\x0F\x0F"
+	"\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F"
+	"\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F"
+	"\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F"
+	"\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F"
+	"\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F"
+	"\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F"
+	"\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F"
+	"\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F"
+;
 } // anonymous namespace
 
-constexpr Particle const&
-particle_classify_find(
-	char const value,
-	std::size_t const index
-) noexcept {
-	return
-	// End or match
-	ParticleKind::invalid == s_particles[index].kind
-	|| value == s_particles[index].value
-		? s_particles[index]
-
-	// Continue
-	: particle_classify_find(value, index + 1u)
-	;
-}
+/**
+	Classify a character.
 
+	@returns Particle for @a value.
+	@param value Character.
+*/
 constexpr Particle const&
 particle_classify(
-	char const value,
-	std::size_t const index = 0u
+	char const value
 ) noexcept {
-	return
-	// Numeral could be width or ElementFlags::zero_padded
-	('0' <= value && value <= '9')
-		? s_particle_numeral
-
-	// Precision specifier
-	: '.' == value
-		? s_particle_precision
-
-	: particle_classify_find(value, index)
-	;
+	return s_particles[static_cast<unsigned char>(
+		s_particle_index[static_cast<unsigned char>(value)]
+	)];
 }
 
 /** @} */ // end of doc-group particle
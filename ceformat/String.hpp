@@ -31,6 +31,13 @@ namespace ceformat {
 */
 using String = CEFORMAT_CONFIG_STRING_TYPE;
 
+/**
+	String view type.
+
+	@note Contents must be UTF-8.
+*/
+using StringView = CEFORMAT_CONFIG_STRING_VIEW_TYPE;
+
 /**
 	Output string stream type.
 */
@@ -0,0 +1,197 @@
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+
+@file
+@brief Atomic record output.
+*/
+
+#pragma once
+
+#include <ceformat/config.hpp>
+#include <ceformat/String.hpp>
+#include <ceformat/Format.hpp>
+#include <ceformat/print.hpp>
+#include <ceformat/sink.hpp>
+
+#include <type_traits>
+#include <utility>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#if CEFORMAT_CONFIG_IOVEC
+	#include <cerrno>
+	#include <unistd.h>
+#endif
+
+namespace ceformat {
+
+/**
+	@addtogroup print
+	@{
+*/
+
+/** @cond INTERNAL */
+namespace detail {
+
+inline String&
+atomic_scratch() {
+	static thread_local String s_scratch;
+	return s_scratch;
+}
+
+// NB: Targets share a fixed set of locks by address
+inline std::mutex&
+atomic_mutex(
+	void const* const target
+) noexcept {
+	static std::mutex s_mutexes[16u];
+	std::uintptr_t const address = reinterpret_cast<std::uintptr_t>(target);
+	return s_mutexes[((address >> 4u) ^ (address >> 12u)) & 15u];
+}
+
+// Scratch range holding one record; released on destruction so that
+// records rendered while rendering another (e.g., by an object) keep
+// the outer record intact
+struct AtomicRecord final {
+	String& scratch;
+	std::size_t const pos;
+
+	AtomicRecord(AtomicRecord const&) = delete;
+	AtomicRecord& operator=(AtomicRecord const&) = delete;
+
+	AtomicRecord() noexcept
+		: scratch(atomic_scratch())
+		, pos(scratch.size())
+	{}
+
+	~AtomicRecord() {
+		this->scratch.resize(this->pos);
+	}
+
+	char const*
+	data() const noexcept {
+		return this->scratch.data() + this->pos;
+	}
+
+	std::size_t
+	size() const noexcept {
+		return this->scratch.size() - this->pos;
+	}
+};
+
+} // namespace detail
+/** @endcond */ // INTERNAL
+
+/**
+	Write format to stream as one write.
+
+	The record is rendered to a thread-local buffer, which is then
+	written to @a stream under a lock, so records written by
+	concurrent calls for the same stream do not interleave.
+
+	@note Output is the same as format_to(); the formatting state of
+	@a stream is not used. Writes to @a stream by other means are not
+	synchronized with this.
+
+	@tparam format %Format.
+	@tparam ...ArgP Argument pack.
+	@param stream Stream to write to.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class... ArgP
+>
+inline void
+write_atomic(
+	std::ostream& stream,
+	ArgP&&... args
+) {
+	detail::AtomicRecord const record{};
+	print_to<format>(record.scratch, std::forward<ArgP>(args)...);
+	std::lock_guard<std::mutex> const lock{detail::atomic_mutex(&stream)};
+	stream.write(record.data(), static_cast<std::streamsize>(record.size()));
+}
+
+/**
+	Write format to sink as one append.
+
+	@remarks Same as write_atomic() to a stream, but to a sink (see
+	sink.hpp).
+
+	@tparam format %Format.
+	@tparam Sink Sink type.
+	@tparam ...ArgP Argument pack.
+	@param sink Sink to write to.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class Sink,
+	class... ArgP
+>
+inline typename std::enable_if<
+	!std::is_base_of<std::ostream, Sink>::value &&
+	!std::is_integral<Sink>::value
+>::type
+write_atomic(
+	Sink& sink,
+	ArgP&&... args
+) {
+	detail::AtomicRecord const record{};
+	print_to<format>(record.scratch, std::forward<ArgP>(args)...);
+	std::lock_guard<std::mutex> const lock{detail::atomic_mutex(&sink)};
+	sink.append(record.data(), record.size());
+}
+
+#if CEFORMAT_CONFIG_IOVEC
+/**
+	Write format to file descriptor with one @c write().
+
+	@remarks No lock is taken. Records do not interleave with other
+	writes to a file opened with @c O_APPEND, or to a pipe if the
+	record is at most @c PIPE_BUF bytes.
+
+	@note A partial write is resumed, but the rest may then be
+	interleaved with other writes.
+
+	@returns @c true if all output was written; otherwise @c errno
+	describes the error.
+	@tparam format %Format.
+	@tparam ...ArgP Argument pack.
+	@param fd File descriptor to write to.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class... ArgP
+>
+inline bool
+write_atomic(
+	int const fd,
+	ArgP&&... args
+) {
+	detail::AtomicRecord const record{};
+	print_to<format>(record.scratch, std::forward<ArgP>(args)...);
+	char const* data = record.data();
+	std::size_t size = record.size();
+	while (0u < size) {
+		ssize_t const written = ::write(fd, data, size);
+		if (0 > written) {
+			if (EINTR == errno) {
+				continue;
+			}
+			return false;
+		}
+		data += written;
+		size -= static_cast<std::size_t>(written);
+	}
+	return true;
+}
+#endif // CEFORMAT_CONFIG_IOVEC
+
+/** @} */ // end of doc-group print
+
+} // namespace ceformat
@@ -11,6 +11,9 @@
 
 #include <string>
 #include <sstream>
+#if 201703L <= __cplusplus
+	#include <string_view>
+#endif
 
 namespace ceformat {
 namespace aux {
@@ -42,6 +45,141 @@ using basic_ostringstream = std::basic_ostringstream<
 	CharT, Traits, CEFORMAT_AUX_ALLOCATOR<CharT>
 >;
 
+#if 201703L <= __cplusplus || defined(DOXYGEN_CONSISTS_SOLELY_OF_UNICORNS_AND_CONFETTI)
+
+/**
+	@c std::basic_string_view<CharT, Traits>.
+
+	@note Prior to C++17, this is a minimal non-owning view with the
+	same construction, access, and output operations.
+*/
+template<
+	class CharT,
+	class Traits = std::char_traits<CharT>
+>
+using basic_string_view = std::basic_string_view<
+	CharT, Traits
+>;
+
+#else // -
+
+template<
+	class CharT,
+	class Traits = std::char_traits<CharT>
+>
+class basic_string_view final {
+public:
+	using traits_type = Traits;
+	using value_type = CharT;
+	using size_type = std::size_t;
+	using const_pointer = CharT const*;
+	using const_iterator = CharT const*;
+
+private:
+	CharT const* m_data;
+	std::size_t m_size;
+
+public:
+	constexpr
+	basic_string_view() noexcept
+		: m_data(nullptr)
+		, m_size(0u)
+	{}
+
+	constexpr
+	basic_string_view(
+		CharT const* const data,
+		std::size_t const size
+	) noexcept
+		: m_data(data)
+		, m_size(size)
+	{}
+
+	basic_string_view(
+		CharT const* const data
+	) noexcept
+		: m_data(data)
+		, m_size(Traits::length(data))
+	{}
+
+	template<class Allocator>
+	basic_string_view(
+		std::basic_string<CharT, Traits, Allocator> const& str
+	) noexcept
+		: m_data(str.data())
+		, m_size(str.size())
+	{}
+
+	constexpr CharT const* data() const noexcept { return m_data; }
+	constexpr std::size_t size() const noexcept { return m_size; }
+	constexpr std::size_t length() const noexcept { return m_size; }
+	constexpr bool empty() const noexcept { return 0u == m_size; }
+	constexpr CharT const* begin() const noexcept { return m_data; }
+	constexpr CharT const* end() const noexcept { return m_data + m_size; }
+
+	constexpr CharT const&
+	operator[](
+		std::size_t const pos
+	) const noexcept {
+		return m_data[pos];
+	}
+};
+
+template<class CharT, class Traits>
+inline bool
+operator==(
+	basic_string_view<CharT, Traits> const x,
+	basic_string_view<CharT, Traits> const y
+) noexcept {
+	return
+		x.size() == y.size() &&
+		0 == Traits::compare(x.data(), y.data(), x.size())
+	;
+}
+
+template<class CharT, class Traits>
+inline bool
+operator!=(
+	basic_string_view<CharT, Traits> const x,
+	basic_string_view<CharT, Traits> const y
+) noexcept {
+	return !(x == y);
+}
+
+template<class CharT, class Traits>
+inline std::basic_ostream<CharT, Traits>&
+operator<<(
+	std::basic_ostream<CharT, Traits>& stream,
+	basic_string_view<CharT, Traits> const view
+) {
+	// NB: Honors width and adjustment like std::basic_string
+	std::streamsize const size = static_cast<std::streamsize>(view.size());
+	std::streamsize const fill
+		= stream.width() > size
+		? stream.width() - size
+		: 0
+	;
+	bool const left
+		= std::ios_base::left
+		== (stream.flags() & std::ios_base::adjustfield)
+	;
+	stream.width(0);
+	if (!left) {
+		for (std::streamsize i = 0; fill > i; ++i) {
+			stream.put(stream.fill());
+		}
+	}
+	stream.write(view.data(), size);
+	if (left) {
+		for (std::streamsize i = 0; fill > i; ++i) {
+			stream.put(stream.fill());
+		}
+	}
+	return stream;
+}
+
+#endif // 201703L <= __cplusplus
+
 /** @} */ // end of doc-group aux
 
 } // namespace aux
@@ -0,0 +1,865 @@
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+
+@file
+@brief Binary encoding.
+*/
+
+#pragma once
+
+#include <ceformat/config.hpp>
+#include <ceformat/String.hpp>
+#include <ceformat/Format.hpp>
+#include <ceformat/DynamicFormat.hpp>
+#include <ceformat/print.hpp>
+#include <ceformat/sink.hpp>
+#include <ceformat/detail/type.hpp>
+#include <ceformat/detail/kernel.hpp>
+
+#include <type_traits>
+#include <utility>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace ceformat {
+
+/**
+	@addtogroup print
+	@{
+*/
+
+/**
+	Result of decode_to().
+*/
+enum class DecodeStatus : unsigned {
+	/** Record decoded. */
+	ok = 0u,
+	/** No more records. */
+	end,
+	/** %Format ID is not in the manifest. */
+	unknown_format,
+	/** Record is truncated or corrupt. */
+	malformed,
+};
+
+/**
+	Formats by ID.
+
+	@remarks Formats are owned by the DynamicFormat::cached() cache.
+*/
+using BinaryManifest = std::unordered_map<
+	std::uint64_t,
+	DynamicFormat const*
+>;
+
+/** @cond INTERNAL */
+namespace detail {
+
+enum : std::uint64_t {
+	FORMAT_ID_BASIS = 0xCBF29CE484222325u,
+	FORMAT_ID_PRIME = 0x100000001B3u,
+};
+
+// FNV-1a
+constexpr std::uint64_t
+format_id_block(
+	char const* const string,
+	std::size_t const beg,
+	std::size_t const end,
+	std::uint64_t const hash
+) noexcept {
+	return
+		end == beg
+		? hash
+		: format_id_block(
+			string, beg + 1u, end,
+			(hash ^ static_cast<unsigned char>(string[beg])) * FORMAT_ID_PRIME
+		)
+	;
+}
+
+constexpr std::uint64_t
+format_id_mix(
+	std::uint64_t const a,
+	std::uint64_t const b
+) noexcept {
+	return (a ^ (b + 0x9E3779B97F4A7C15u + (a << 6u) + (a >> 2u))) * FORMAT_ID_PRIME;
+}
+
+// NB: Blocks are folded pairwise to keep the constexpr recursion depth
+// logarithmic in the size of the string
+constexpr std::uint64_t
+format_id_range(
+	char const* const string,
+	std::size_t const beg,
+	std::size_t const end
+) noexcept {
+	return
+		16u >= end - beg
+		? format_id_block(string, beg, end, FORMAT_ID_BASIS)
+		: format_id_mix(
+			format_id_range(string, beg, beg + (end - beg) / 2u),
+			format_id_range(string, beg + (end - beg) / 2u, end)
+		)
+	;
+}
+
+enum class BinaryKind : unsigned {
+	integer = 0u,
+	floating_point,
+	boolean,
+	pointer,
+	string,
+};
+
+enum : unsigned {
+	BINARY_SIGNED = 1u << 2u,
+	BINARY_NULL = 1u,
+};
+
+constexpr unsigned
+binary_size_code(
+	std::size_t const size
+) noexcept {
+	return
+		  1u == size ? 0u
+		: 2u == size ? 1u
+		: 4u == size ? 2u
+		: 3u
+	;
+}
+
+template<class Sink>
+inline void
+binary_tag(
+	Sink& sink,
+	BinaryKind const kind,
+	unsigned const bits
+) {
+	sink.append(
+		static_cast<char>((static_cast<unsigned>(kind) << 4u) | bits),
+		1u
+	);
+}
+
+template<class Sink>
+inline void
+binary_varint(
+	Sink& sink,
+	std::uint64_t value
+) {
+	char buffer[10u];
+	std::size_t size = 0u;
+	while (0x80u <= value) {
+		buffer[size++] = static_cast<char>(0x80u | (value & 0x7Fu));
+		value >>= 7u;
+	}
+	buffer[size++] = static_cast<char>(value);
+	sink.append(buffer, size);
+}
+
+template<class Sink>
+inline void
+binary_id(
+	Sink& sink,
+	std::uint64_t const id
+) {
+	char buffer[8u];
+	for (unsigned i = 0u; 8u > i; ++i) {
+		buffer[i] = static_cast<char>((id >> (8u * i)) & 0xFFu);
+	}
+	sink.append(buffer, 8u);
+}
+
+template<class Sink>
+inline void
+binary_string(
+	Sink& sink,
+	char const* const data,
+	std::size_t const size
+) {
+	binary_tag(sink, BinaryKind::string, 0u);
+	binary_varint(sink, size);
+	sink.append(data, size);
+}
+
+// integral
+
+template<class Sink, class T>
+inline typename std::enable_if<
+	tte_integral<T>() && std::is_signed<rm_cref_t<T>>::value
+>::type
+encode_value(
+	Sink& sink,
+	T&& value
+) {
+	using V = rm_cref_t<T>;
+	static_assert(8u >= sizeof(V), "integral type is too wide to encode");
+	// zigzag
+	std::uint64_t const u = static_cast<std::uint64_t>(value);
+	binary_tag(
+		sink, BinaryKind::integer,
+		binary_size_code(sizeof(V)) | BINARY_SIGNED
+	);
+	binary_varint(sink, (u << 1u) ^ (0u - (u >> 63u)));
+}
+
+template<class Sink, class T>
+inline typename std::enable_if<
+	tte_integral<T>() && !std::is_signed<rm_cref_t<T>>::value
+>::type
+encode_value(
+	Sink& sink,
+	T&& value
+) {
+	using V = rm_cref_t<T>;
+	static_assert(8u >= sizeof(V), "integral type is too wide to encode");
+	binary_tag(sink, BinaryKind::integer, binary_size_code(sizeof(V)));
+	binary_varint(sink, static_cast<std::uint64_t>(value));
+}
+
+// floating-point
+
+template<class Sink, class T>
+inline typename std::enable_if<
+	tte_floating_point<T>()
+>::type
+encode_value(
+	Sink& sink,
+	T&& value
+) {
+	using V = rm_cref_t<T>;
+	char buffer[sizeof(V)];
+	std::memcpy(buffer, &value, sizeof(V));
+	binary_tag(
+		sink, BinaryKind::floating_point,
+		  std::is_same<float, V>::value ? 0u
+		: std::is_same<double, V>::value ? 1u
+		: 2u
+	);
+	sink.append(buffer, sizeof(V));
+}
+
+// boolean
+
+template<class Sink>
+inline void
+encode_value(
+	Sink& sink,
+	bool const value
+) {
+	binary_tag(sink, BinaryKind::boolean, value ? 1u : 0u);
+}
+
+// pointer
+
+template<class Sink>
+inline void
+encode_value(
+	Sink& sink,
+	void const* const value
+) {
+	binary_tag(sink, BinaryKind::pointer, 0u);
+	binary_varint(sink, reinterpret_cast<std::uintptr_t>(value));
+}
+
+// string
+
+template<class Sink>
+inline void
+encode_value(
+	Sink& sink,
+	char const* const value
+) {
+	if (nullptr != value) {
+		binary_string(sink, value, std::strlen(value));
+	} else {
+		binary_tag(sink, BinaryKind::string, BINARY_NULL);
+	}
+}
+
+template<class Sink>
+inline void
+encode_value(
+	Sink& sink,
+	String const& value
+) {
+	binary_string(sink, value.data(), value.size());
+}
+
+template<class Sink>
+inline void
+encode_value(
+	Sink& sink,
+	StringView const value
+) {
+	binary_string(sink, value.data(), value.size());
+}
+
+// object
+
+// NB: Width and padding are applied when decoding, so objects are
+// padded as a whole instead of by their first output operation
+template<class Sink, class T>
+inline typename std::enable_if<
+	tte_object<T>()
+>::type
+encode_value(
+	Sink& sink,
+	T&& value
+) {
+	OutputStringStream stream;
+	stream << std::forward<T>(value);
+	String const str = stream.str();
+	binary_string(sink, str.data(), str.size());
+}
+
+template<class Sink>
+inline void
+encode_impl(
+	Sink& /*sink*/
+) noexcept {}
+
+template<
+	class Sink,
+	class ArgF,
+	class... ArgP
+>
+inline void
+encode_impl(
+	Sink& sink,
+	ArgF&& front,
+	ArgP&&... args
+) {
+	encode_value(
+		sink,
+		static_cast<typename type_to_element<ArgF>::cast>(
+			std::forward<ArgF>(front)
+		)
+	);
+	encode_impl(sink, std::forward<ArgP>(args)...);
+}
+
+struct BinaryManifestEntry final {
+	std::uint64_t const id;
+	char const* const string;
+	std::size_t const size;
+	BinaryManifestEntry const* next;
+};
+
+inline std::atomic<BinaryManifestEntry const*>&
+binary_manifest_head() noexcept {
+	static std::atomic<BinaryManifestEntry const*> s_head{nullptr};
+	return s_head;
+}
+
+struct BinaryReader final {
+	char const* pos;
+	char const* const end;
+
+	bool
+	read(
+		void* const data,
+		std::size_t const size
+	) noexcept {
+		if (static_cast<std::size_t>(this->end - this->pos) < size) {
+			return false;
+		}
+		std::memcpy(data, this->pos, size);
+		this->pos += size;
+		return true;
+	}
+
+	bool
+	read_varint(
+		std::uint64_t& value
+	) noexcept {
+		value = 0u;
+		for (unsigned shift = 0u; 64u > shift; shift += 7u) {
+			if (this->end == this->pos) {
+				return false;
+			}
+			unsigned const byte = static_cast<unsigned char>(*this->pos++);
+			value |= static_cast<std::uint64_t>(byte & 0x7Fu) << shift;
+			if (0u == (byte & 0x80u)) {
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+template<class Sink>
+inline bool
+decode_integer(
+	Sink& sink,
+	BinaryReader& reader,
+	Element const& element,
+	char const spec,
+	unsigned const bits
+) {
+	std::uint64_t value;
+	if (!reader.read_varint(value)) {
+		return false;
+	}
+	if (0u != (bits & BINARY_SIGNED)) {
+		std::int64_t const s
+			= static_cast<std::int64_t>(value >> 1u)
+			^ -static_cast<std::int64_t>(value & 1u)
+		;
+		switch (bits & 3u) {
+		case 0u: write_value(sink, element, spec, static_cast<signed char>(s)); break;
+		case 1u: write_value(sink, element, spec, static_cast<std::int16_t>(s)); break;
+		case 2u: write_value(sink, element, spec, static_cast<std::int32_t>(s)); break;
+		default: write_value(sink, element, spec, s); break;
+		}
+	} else {
+		switch (bits & 3u) {
+		case 0u: write_value(sink, element, spec, static_cast<unsigned char>(value)); break;
+		case 1u: write_value(sink, element, spec, static_cast<std::uint16_t>(value)); break;
+		case 2u: write_value(sink, element, spec, static_cast<std::uint32_t>(value)); break;
+		default: write_value(sink, element, spec, value); break;
+		}
+	}
+	return true;
+}
+
+template<class Sink, class V>
+inline bool
+decode_floating_point(
+	Sink& sink,
+	BinaryReader& reader,
+	Element const& element,
+	char const spec
+) {
+	V value;
+	if (!reader.read(&value, sizeof(V))) {
+		return false;
+	}
+	write_value(sink, element, spec, value);
+	return true;
+}
+
+template<class Sink>
+inline bool
+decode_value(
+	Sink& sink,
+	BinaryReader& reader,
+	Element const& element,
+	char const spec
+) {
+	unsigned char tag;
+	if (!reader.read(&tag, 1u)) {
+		return false;
+	}
+	unsigned const bits = tag & 0x0Fu;
+	std::uint64_t value;
+	switch (static_cast<BinaryKind>(tag >> 4u)) {
+	case BinaryKind::integer:
+		return decode_integer(sink, reader, element, spec, bits);
+
+	case BinaryKind::floating_point:
+		switch (bits) {
+		case 0u: return decode_floating_point<Sink, float>(sink, reader, element, spec);
+		case 1u: return decode_floating_point<Sink, double>(sink, reader, element, spec);
+		case 2u: return decode_floating_point<Sink, long double>(sink, reader, element, spec);
+		default: return false;
+		}
+
+	case BinaryKind::boolean:
+		write_value(sink, element, spec, 0u != (bits & 1u));
+		return true;
+
+	case BinaryKind::pointer:
+		if (!reader.read_varint(value)) {
+			return false;
+		}
+		write_value(
+			sink, element, spec,
+			reinterpret_cast<void const*>(static_cast<std::uintptr_t>(value))
+		);
+		return true;
+
+	case BinaryKind::string:
+		if (0u != (bits & BINARY_NULL)) {
+			write_value(sink, element, spec, static_cast<char const*>(nullptr));
+			return true;
+		}
+		if (
+			!reader.read_varint(value) ||
+			static_cast<std::uint64_t>(reader.end - reader.pos) < value
+		) {
+			return false;
+		}
+		write_value(
+			sink, element, spec,
+			StringView{reader.pos, static_cast<std::size_t>(value)}
+		);
+		reader.pos += value;
+		return true;
+	}
+	return false;
+}
+
+inline unsigned
+manifest_hex(
+	char const c
+) noexcept {
+	return
+		  ('0' <= c && '9' >= c) ? static_cast<unsigned>(c - '0')
+		: ('a' <= c && 'f' >= c) ? static_cast<unsigned>(c - 'a' + 10)
+		: ('A' <= c && 'F' >= c) ? static_cast<unsigned>(c - 'A' + 10)
+		: 16u
+	;
+}
+
+inline bool
+manifest_unescape(
+	String const& line,
+	std::size_t pos,
+	String& out
+) {
+	while (line.size() > pos) {
+		char const c = line[pos++];
+		if ('\\' != c) {
+			out.push_back(c);
+			continue;
+		} else if (line.size() == pos) {
+			return false;
+		}
+		switch (line[pos++]) {
+		case '\\': out.push_back('\\'); break;
+		case 'n': out.push_back('\n'); break;
+		case 'r': out.push_back('\r'); break;
+		case 't': out.push_back('\t'); break;
+		case 'x': {
+			if (line.size() < pos + 2u) {
+				return false;
+			}
+			unsigned const hi = manifest_hex(line[pos]);
+			unsigned const lo = manifest_hex(line[pos + 1u]);
+			if (16u <= hi || 16u <= lo) {
+				return false;
+			}
+			out.push_back(static_cast<char>((hi << 4u) | lo));
+			pos += 2u;
+		}	break;
+
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace detail
+
+namespace {
+
+template<Format const& format>
+struct BinaryRegistration final {
+	detail::BinaryManifestEntry entry;
+
+	static BinaryRegistration s_instance;
+
+	BinaryRegistration() noexcept;
+};
+
+template<Format const& format>
+BinaryRegistration<format> BinaryRegistration<format>::s_instance{};
+
+} // anonymous namespace
+/** @endcond */ // INTERNAL
+
+/**
+	Get ID of format string.
+
+	@remarks This is a 64-bit FNV-1a hash of 16-character blocks of
+	@a string, folded pairwise. It is stable across builds and
+	platforms.
+
+	@returns ID of @a string.
+	@param string %Format string.
+	@param size Size of @a string.
+*/
+constexpr std::uint64_t
+format_id(
+	char const* const string,
+	std::size_t const size
+) noexcept {
+	return detail::format_id_mix(
+		detail::format_id_range(string, 0u, size),
+		size
+	);
+}
+
+/**
+	Get ID of format.
+
+	@returns ID of @a format.
+	@tparam format %Format.
+*/
+template<Format const& format>
+constexpr std::uint64_t
+format_id() noexcept {
+	return format_id(format.string, format.size);
+}
+
+/** @cond INTERNAL */
+template<Format const& format>
+inline
+BinaryRegistration<format>::BinaryRegistration() noexcept
+	: entry{format_id<format>(), format.string, format.size, nullptr}
+{
+	auto& head = detail::binary_manifest_head();
+	this->entry.next = head.load(std::memory_order_relaxed);
+	while (!head.compare_exchange_weak(
+		this->entry.next, &this->entry,
+		std::memory_order_release,
+		std::memory_order_relaxed
+	)) {}
+}
+/** @endcond */ // INTERNAL
+
+/**
+	Encode format record to character buffer.
+
+	A record is the format ID (format_id(); 8 bytes, little-endian)
+	followed by the arguments, each as a tag byte and a payload:
+
+	- integral: varint (LEB128), zigzag-encoded if signed
+	- floating-point: bytes of the value (native order)
+	- boolean: none (value is in the tag)
+	- pointer: varint
+	- string: varint size and characters; objects are rendered when
+	  encoding
+
+	Text is rendered later by decode_to() with the format from a
+	manifest (see write_manifest()).
+
+	@note Output is truncated at @a last; a truncated record cannot
+	be decoded.
+
+	@remarks @a format is added to the manifest (see
+	write_manifest()) when the program starts.
+
+	@returns Same as format_to().
+	@tparam format %Format.
+	@tparam ...ArgP Argument pack; checked like write().
+	@param first Beginning of buffer.
+	@param last End of buffer.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class... ArgP
+>
+inline FormatToResult
+encode(
+	char* const first,
+	char* const last,
+	ArgP&&... args
+) {
+	check_args<format, ArgP...>();
+	static_cast<void>(&BinaryRegistration<format>::s_instance);
+	BufferSink sink{first, last, 0u};
+	detail::binary_id(sink, format_id<format>());
+	detail::encode_impl(sink, std::forward<ArgP>(args)...);
+	return FormatToResult{sink.pos, sink.size};
+}
+
+/**
+	Append format record to string.
+
+	@remarks Same as encode(), but to a string.
+
+	@returns @a out.
+	@tparam format %Format.
+	@tparam ...ArgP Argument pack; checked like write().
+	@param out String to append to.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class... ArgP
+>
+inline String&
+encode_to(
+	String& out,
+	ArgP&&... args
+) {
+	check_args<format, ArgP...>();
+	static_cast<void>(&BinaryRegistration<format>::s_instance);
+	StringSink sink{out};
+	detail::binary_id(sink, format_id<format>());
+	detail::encode_impl(sink, std::forward<ArgP>(args)...);
+	return out;
+}
+
+/**
+	Write manifest of encoded formats.
+
+	@remarks The manifest has every format that the program can
+	encode() (whether or not it has), one per line as the hexadecimal
+	ID, a space, and the format string with backslash, control
+	characters and DEL escaped (<code>\\\\</code>, <code>\\n</code>,
+	<code>\\r</code>, <code>\\t</code>, <code>\\xHH</code>). Lines
+	starting with @c # are comments.
+
+	@param stream Stream to write to.
+*/
+inline void
+write_manifest(
+	std::ostream& stream
+) {
+	static char const s_hex[] = "0123456789abcdef";
+	std::unordered_set<std::uint64_t> written;
+	stream << "# ceformat binary manifest\n";
+	for (
+		detail::BinaryManifestEntry const* entry
+			= detail::binary_manifest_head().load(std::memory_order_acquire);
+		nullptr != entry;
+		entry = entry->next
+	) {
+		if (!written.insert(entry->id).second) {
+			continue;
+		}
+		String line;
+		line.reserve(17u + entry->size + 1u);
+		for (unsigned i = 16u; 0u < i; --i) {
+			line.push_back(s_hex[(entry->id >> (4u * (i - 1u))) & 0xFu]);
+		}
+		line.push_back(' ');
+		for (std::size_t i = 0u; entry->size > i; ++i) {
+			unsigned char const c = static_cast<unsigned char>(entry->string[i]);
+			switch (c) {
+			case '\\': line.append("\\\\"); break;
+			case '\n': line.append("\\n"); break;
+			case '\r': line.append("\\r"); break;
+			case '\t': line.append("\\t"); break;
+			default:
+				if (0x20u > c || 0x7Fu == c) {
+					line.append("\\x");
+					line.push_back(s_hex[c >> 4u]);
+					line.push_back(s_hex[c & 0xFu]);
+				} else {
+					line.push_back(static_cast<char>(c));
+				}
+				break;
+			}
+		}
+		line.push_back('\n');
+		stream.write(line.data(), static_cast<std::streamsize>(line.size()));
+	}
+}
+
+/**
+	Read manifest.
+
+	@throws std::logic_error If a format string in the manifest is
+	invalid.
+	@returns @c true if the manifest was read; @c false if a line is
+	malformed (entries before it are kept).
+	@param stream Stream to read from.
+	@param manifest Manifest to add formats to.
+*/
+inline bool
+read_manifest(
+	std::istream& stream,
+	BinaryManifest& manifest
+) {
+	String line;
+	String string;
+	while (std::getline(stream, line)) {
+		if (line.empty() || '#' == line[0u]) {
+			continue;
+		} else if (17u > line.size() || ' ' != line[16u]) {
+			return false;
+		}
+		std::uint64_t id = 0u;
+		for (std::size_t i = 0u; 16u > i; ++i) {
+			unsigned const digit = detail::manifest_hex(line[i]);
+			if (16u <= digit) {
+				return false;
+			}
+			id = (id << 4u) | digit;
+		}
+		string.clear();
+		if (!detail::manifest_unescape(line, 17u, string)) {
+			return false;
+		}
+		manifest[id] = &DynamicFormat::cached(
+			StringView{string.data(), string.size()}
+		);
+	}
+	return true;
+}
+
+/**
+	Decode record to string.
+
+	@remarks Output is the same as print_to() with the arguments that
+	were encoded, except that objects are padded as strings.
+
+	@returns
+	- DecodeStatus::ok: the record at @a pos was appended to @a out
+	  and @a pos is past the record.
+	- DecodeStatus::end: @a pos is @a end.
+	- otherwise: @a out and @a pos are unchanged. Records are not
+	  delimited, so no further records can be decoded.
+	@param out String to append to.
+	@param manifest Manifest.
+	@param pos Position of record.
+	@param end End of records.
+*/
+inline DecodeStatus
+decode_to(
+	String& out,
+	BinaryManifest const& manifest,
+	char const*& pos,
+	char const* const end
+) {
+	if (end == pos) {
+		return DecodeStatus::end;
+	}
+	detail::BinaryReader reader{pos, end};
+	unsigned char raw[8u];
+	if (!reader.read(raw, 8u)) {
+		return DecodeStatus::malformed;
+	}
+	std::uint64_t id = 0u;
+	for (unsigned i = 8u; 0u < i; --i) {
+		id = (id << 8u) | raw[i - 1u];
+	}
+	auto const it = manifest.find(id);
+	if (manifest.end() == it) {
+		return DecodeStatus::unknown_format;
+	}
+	DynamicFormat const& format = *it->second;
+	std::size_t const size = out.size();
+	StringSink sink{out};
+	for (std::size_t index = 0u; format.literal_count >= index; ++index) {
+		Segment const& segment = format.segments[index];
+		sink.append(format.literal.data() + segment.beg, segment.size);
+		if (format.literal_count == index) {
+			break;
+		}
+		Element const& element = format.elements[segment.element];
+		if (!detail::decode_value(sink, reader, element, format.spec(element))) {
+			out.resize(size);
+			return DecodeStatus::malformed;
+		}
+	}
+	pos = reader.pos;
+	return DecodeStatus::ok;
+}
+
+/** @} */ // end of doc-group print
+
+} // namespace ceformat
@@ -36,6 +36,17 @@ namespace ceformat {
 */
 #define CEFORMAT_CONFIG_STRING_TYPE
 
+/**
+	String view type.
+	Defaults to @c aux::basic_string_view<char>.
+
+	@note ceformat requires this type to be constructible from a
+	pointer and size, as @c std::string_view is.
+
+	@sa @ref string
+*/
+#define CEFORMAT_CONFIG_STRING_VIEW_TYPE
+
 /**
 	String stream type.
 	Defaults to @c aux::basic_ostringstream<char>.
@@ -47,6 +58,43 @@ namespace ceformat {
 */
 #define CEFORMAT_CONFIG_OSTRINGSTREAM_TYPE
 
+/**
+	Maximum number of elements in a format.
+	Defaults to 16.
+
+	@note Every format reserves storage for this many elements (18
+	bytes each), so it should be raised only as far as the largest
+	format in the program requires. It must be the same in all
+	translation units.
+*/
+#define CEFORMAT_CONFIG_ELEMENTS_MAX
+
+/**
+	Whether to use SIMD kernels.
+	Defaults to 1.
+
+	@note SIMD kernels are only used if the target supports them
+	(SSE2); otherwise scalar kernels are used.
+*/
+#define CEFORMAT_CONFIG_SIMD
+
+/**
+	Whether to provide file descriptor output (IovecSink, write_fd()
+	and write_atomic() to a file descriptor).
+	Defaults to 1 on POSIX systems and 0 otherwise.
+
+	@note This requires @c <sys/uio.h> and @c <unistd.h>.
+*/
+#define CEFORMAT_CONFIG_IOVEC
+
+/**
+	Whether to provide @c std::pmr overloads (e.g., print() with a
+	memory resource).
+	Defaults to 1 if @c <memory_resource> is available (C++17) and 0
+	otherwise.
+*/
+#define CEFORMAT_CONFIG_PMR
+
 #else // -
 
 #ifndef CEFORMAT_AUX_ALLOCATOR
@@ -59,11 +107,43 @@ namespace ceformat {
 		aux::basic_string<char>
 #endif
 
+#ifndef CEFORMAT_CONFIG_STRING_VIEW_TYPE
+	#define CEFORMAT_CONFIG_STRING_VIEW_TYPE \
+		aux::basic_string_view<char>
+#endif
+
 #ifndef CEFORMAT_CONFIG_OSTRINGSTREAM_TYPE
 	#define CEFORMAT_CONFIG_OSTRINGSTREAM_TYPE \
 		aux::basic_ostringstream<char>
 #endif
 
+#ifndef CEFORMAT_CONFIG_ELEMENTS_MAX
+	#define CEFORMAT_CONFIG_ELEMENTS_MAX 16
+#endif
+
+#ifndef CEFORMAT_CONFIG_SIMD
+	#define CEFORMAT_CONFIG_SIMD 1
+#endif
+
+#ifndef CEFORMAT_CONFIG_IOVEC
+	#if defined(__unix__) || defined(__APPLE__)
+		#define CEFORMAT_CONFIG_IOVEC 1
+	#else
+		#define CEFORMAT_CONFIG_IOVEC 0
+	#endif
+#endif
+
+#ifndef CEFORMAT_CONFIG_PMR
+	#if 201703L <= __cplusplus && defined(__has_include)
+		#if __has_include(<memory_resource>)
+			#define CEFORMAT_CONFIG_PMR 1
+		#endif
+	#endif
+	#ifndef CEFORMAT_CONFIG_PMR
+		#define CEFORMAT_CONFIG_PMR 0
+	#endif
+#endif
+
 #endif // DOXYGEN_CONSISTS_SOLELY_OF_UNICORNS_AND_CONFETTI
 
 /** @} */ // end of doc-group config
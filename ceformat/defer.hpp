@@ -0,0 +1,765 @@
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+
+@file
+@brief Deferred formatting.
+*/
+
+#pragma once
+
+#include <ceformat/config.hpp>
+#include <ceformat/String.hpp>
+#include <ceformat/Format.hpp>
+#include <ceformat/print.hpp>
+#include <ceformat/sink.hpp>
+#include <ceformat/detail/type.hpp>
+#include <ceformat/detail/kernel.hpp>
+
+#include <type_traits>
+#include <utility>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+
+namespace ceformat {
+
+/**
+	@addtogroup print
+	@{
+*/
+
+/**
+	Backpressure policy of a DeferQueue.
+*/
+enum class DeferPolicy : unsigned {
+	/** Discard records while the queue is full. */
+	drop = 0u,
+	/** Wait for space while the queue is full. */
+	block,
+	/**
+		Discard records while the queue is full and count them (see
+		DeferQueue::overflow_count()).
+	*/
+	count,
+};
+
+/**
+	Deferred reference to an object.
+
+	@warning The object must outlive rendering of the record.
+*/
+template<class T>
+struct DeferRef final {
+	/** Object. */
+	T const* value;
+};
+
+/**
+	Capture object by reference for defer().
+
+	@returns Reference to @a value.
+	@param value Object.
+*/
+template<class T>
+inline DeferRef<T>
+defer_ref(
+	T const& value
+) noexcept {
+	return DeferRef<T>{&value};
+}
+
+/** @cond INTERNAL */
+template<class T>
+inline std::ostream&
+operator<<(
+	std::ostream& stream,
+	DeferRef<T> const& ref
+) {
+	return stream << *ref.value;
+}
+/** @endcond */
+
+/**
+	Argument capture for defer().
+
+	Integral, floating-point, boolean and pointer arguments are copied
+	into the record. Strings are always copied into the record (see
+	defer()). Objects (non-string @c ElementType::str arguments) have
+	no capture; they must either be passed through defer_ref() or have
+	a specialization of this with:
+
+	@code
+	using type = ...; // trivially copyable and printable with operator<<
+	static type capture(T const& value);
+	@endcode
+*/
+template<
+	class T,
+	class = void
+>
+struct defer_capture {};
+
+/** @cond INTERNAL */
+template<class T>
+struct defer_capture<
+	T,
+	typename std::enable_if<
+		detail::tte_integral<T>() ||
+		detail::tte_floating_point<T>() ||
+		detail::tte_boolean<T>()
+	>::type
+> {
+	using type = T;
+
+	static type
+	capture(
+		T const value
+	) noexcept {
+		return value;
+	}
+};
+
+template<class T>
+struct defer_capture<
+	T,
+	typename std::enable_if<
+		detail::tte_pointer<T>()
+	>::type
+> {
+	using type = void const*;
+
+	static type
+	capture(
+		T const value
+	) noexcept {
+		return value;
+	}
+};
+
+template<class T>
+struct defer_capture<DeferRef<T>, void> {
+	using type = DeferRef<T>;
+
+	static type
+	capture(
+		DeferRef<T> const value
+	) noexcept {
+		return value;
+	}
+};
+
+namespace detail {
+
+using DeferRender = void (*)(String&, unsigned char const*);
+
+// String copied into the record payload
+struct DeferString final {
+	std::uint16_t offset;
+	std::uint16_t size;
+};
+
+// Appends strings past the captured arguments in the record payload
+struct DeferWriter final {
+	unsigned char* const payload;
+	std::size_t pos;
+	std::size_t const capacity;
+	bool truncated;
+
+	DeferString
+	append(
+		char const* const data,
+		std::size_t const size
+	) noexcept {
+		std::size_t copy = size;
+		if (this->capacity - this->pos < size) {
+			copy = this->capacity - this->pos;
+			this->truncated = true;
+		}
+		std::memcpy(this->payload + this->pos, data, copy);
+		DeferString const string{
+			static_cast<std::uint16_t>(this->pos),
+			static_cast<std::uint16_t>(copy)
+		};
+		this->pos += copy;
+		return string;
+	}
+};
+
+template<
+	class T,
+	class = void
+>
+struct defer_has_capture {
+	static constexpr bool value = false;
+};
+
+template<class T>
+struct defer_has_capture<
+	T,
+	typename std::conditional<
+		true,
+		void,
+		typename defer_capture<rm_cref_t<T>>::type
+	>::type
+> {
+	static constexpr bool value = true;
+};
+
+struct DeferInvalid final {};
+
+template<class T>
+struct defer_captured {
+	using type = typename std::conditional<
+		tte_string_native<T>(),
+		DeferString,
+		typename std::conditional<
+			defer_has_capture<T>::value,
+			defer_capture<rm_cref_t<T>>,
+			std::enable_if<true, DeferInvalid>
+		>::type::type
+	>::type;
+};
+
+template<class... T>
+struct defer_capturable;
+
+template<>
+struct defer_capturable<> {
+	static constexpr bool value = true;
+};
+
+template<class T, class... P>
+struct defer_capturable<T, P...> {
+	static constexpr bool value
+		= (tte_string_native<T>() || defer_has_capture<T>::value)
+		&& defer_capturable<P...>::value
+	;
+};
+
+template<class... T>
+struct DeferPack;
+
+template<>
+struct DeferPack<> {};
+
+template<class T, class... P>
+struct DeferPack<T, P...> {
+	T head;
+	DeferPack<P...> tail;
+};
+
+inline StringView
+defer_view(
+	char const* const value
+) noexcept {
+	return
+		nullptr != value
+		? StringView(value, std::strlen(value))
+		: StringView()
+	;
+}
+
+inline StringView
+defer_view(
+	String const& value
+) noexcept {
+	return StringView(value.data(), value.size());
+}
+
+inline StringView
+defer_view(
+	StringView const value
+) noexcept {
+	return value;
+}
+
+template<class T>
+inline typename std::enable_if<
+	tte_string_native<T const&>(),
+	DeferString
+>::type
+defer_capture_arg(
+	DeferWriter& writer,
+	T const& value
+) {
+	StringView const view = defer_view(value);
+	return writer.append(view.data(), view.size());
+}
+
+template<class T>
+inline typename std::enable_if<
+	!tte_string_native<T const&>(),
+	typename defer_captured<T const&>::type
+>::type
+defer_capture_arg(
+	DeferWriter& /*writer*/,
+	T const& value
+) {
+	return defer_capture<rm_cref_t<T>>::capture(value);
+}
+
+inline DeferPack<>
+defer_pack(
+	DeferWriter& /*writer*/
+) noexcept {
+	return DeferPack<>{};
+}
+
+template<
+	class ArgF,
+	class... ArgP
+>
+inline DeferPack<
+	typename defer_captured<ArgF const&>::type,
+	typename defer_captured<ArgP const&>::type...
+>
+defer_pack(
+	DeferWriter& writer,
+	ArgF const& front,
+	ArgP const&... args
+) {
+	// NB: Braced initializers are evaluated in order
+	return DeferPack<
+		typename defer_captured<ArgF const&>::type,
+		typename defer_captured<ArgP const&>::type...
+	>{
+		defer_capture_arg(writer, front),
+		defer_pack(writer, args...)
+	};
+}
+
+template<class T>
+inline T const&
+defer_resolve(
+	unsigned char const* const /*payload*/,
+	T const& value
+) noexcept {
+	return value;
+}
+
+inline StringView
+defer_resolve(
+	unsigned char const* const payload,
+	DeferString const& value
+) noexcept {
+	return StringView(
+		reinterpret_cast<char const*>(payload + value.offset),
+		value.size
+	);
+}
+
+} // namespace detail
+
+namespace {
+
+template<
+	Format const& format,
+	class Sink,
+	class... R
+>
+inline void
+defer_apply(
+	Sink& sink,
+	unsigned char const* const /*payload*/,
+	detail::DeferPack<> const& /*pack*/,
+	R&&... resolved
+) {
+	write_impl<format, 0u>(
+		sink,
+		std::forward<R>(resolved)...
+	);
+}
+
+template<
+	Format const& format,
+	class Sink,
+	class T,
+	class... P,
+	class... R
+>
+inline void
+defer_apply(
+	Sink& sink,
+	unsigned char const* const payload,
+	detail::DeferPack<T, P...> const& pack,
+	R&&... resolved
+) {
+	defer_apply<format>(
+		sink,
+		payload,
+		pack.tail,
+		std::forward<R>(resolved)...,
+		detail::defer_resolve(payload, pack.head)
+	);
+}
+
+template<
+	Format const& format,
+	class Pack
+>
+void
+defer_render(
+	String& out,
+	unsigned char const* const payload
+) {
+	StringSink sink{out};
+	defer_apply<format>(
+		sink,
+		payload,
+		*reinterpret_cast<Pack const*>(payload)
+	);
+}
+} // anonymous namespace
+/** @endcond */ // INTERNAL
+
+/**
+	Bounded lock-free queue of deferred records.
+
+	Records are enqueued by defer() and rendered by drain() or
+	drain_to(). Any number of threads may enqueue and drain
+	concurrently.
+
+	@tparam capacity Number of records; must be a power of two.
+	@tparam policy Backpressure policy.
+	@tparam record_size Size of the payload of each record, which
+	holds captured arguments and copied strings.
+*/
+template<
+	std::size_t capacity,
+	DeferPolicy policy = DeferPolicy::drop,
+	std::size_t record_size = 128u
+>
+class DeferQueue final {
+	static_assert(
+		0u != capacity && 0u == (capacity & (capacity - 1u)),
+		"capacity must be a power of two"
+	);
+	static_assert(
+		0u != record_size && UINT16_MAX >= record_size,
+		"record_size must be in [1, 65535]"
+	);
+
+public:
+	/** Payload size of each record. */
+	static constexpr std::size_t const
+	payload_size = record_size;
+
+private:
+	struct Cell final {
+		std::atomic<std::size_t> sequence;
+		detail::DeferRender render;
+		alignas(std::max_align_t) unsigned char payload[record_size];
+	};
+
+	// NB: Producer and consumer positions are kept on separate cache
+	// lines (padded rather than aligned, so the queue can be allocated
+	// with new prior to C++17)
+	Cell m_cells[capacity];
+	std::atomic<std::size_t> m_enqueue;
+	char m_pad[64u];
+	std::atomic<std::size_t> m_dequeue;
+	std::atomic<std::size_t> m_overflow;
+	std::atomic<std::size_t> m_truncated;
+
+	// Releases a cell to producers
+	struct Release final {
+		Cell& cell;
+		std::size_t const sequence;
+
+		~Release() {
+			this->cell.sequence.store(this->sequence, std::memory_order_release);
+		}
+	};
+
+	bool
+	render_next(
+		String& out
+	) {
+		std::size_t pos = this->m_dequeue.load(std::memory_order_relaxed);
+		Cell* cell;
+		for (;;) {
+			cell = &this->m_cells[pos & (capacity - 1u)];
+			std::intptr_t const diff
+				= static_cast<std::intptr_t>(
+					cell->sequence.load(std::memory_order_acquire)
+				)
+				- static_cast<std::intptr_t>(pos + 1u)
+			;
+			if (0 == diff) {
+				if (this->m_dequeue.compare_exchange_weak(
+					pos, pos + 1u, std::memory_order_relaxed
+				)) {
+					break;
+				}
+			} else if (0 > diff) {
+				return false;
+			} else {
+				pos = this->m_dequeue.load(std::memory_order_relaxed);
+			}
+		}
+		Release const release{*cell, pos + capacity};
+		cell->render(out, cell->payload);
+		return true;
+	}
+
+public:
+	DeferQueue(DeferQueue const&) = delete;
+	DeferQueue& operator=(DeferQueue const&) = delete;
+
+	/** Construct empty queue. */
+	DeferQueue() noexcept
+		: m_enqueue(0u)
+		, m_dequeue(0u)
+		, m_overflow(0u)
+		, m_truncated(0u)
+	{
+		for (std::size_t i = 0u; capacity > i; ++i) {
+			this->m_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+		Enqueue a record.
+
+		@note This is used by defer().
+
+		@returns @c true if the record was enqueued; @c false if the
+		queue was full (with DeferPolicy::drop or DeferPolicy::count).
+		@param fill Function which fills the record payload and
+		returns its render function, called as
+		<code>fill(payload, truncated)</code>; it sets the @c bool
+		@a truncated if strings were truncated to fit the payload
+		(counted by truncated_count()).
+	*/
+	template<class F>
+	bool
+	enqueue(
+		F&& fill
+	) noexcept {
+		std::size_t pos = this->m_enqueue.load(std::memory_order_relaxed);
+		Cell* cell;
+		for (;;) {
+			cell = &this->m_cells[pos & (capacity - 1u)];
+			std::intptr_t const diff
+				= static_cast<std::intptr_t>(
+					cell->sequence.load(std::memory_order_acquire)
+				)
+				- static_cast<std::intptr_t>(pos)
+			;
+			if (0 == diff) {
+				if (this->m_enqueue.compare_exchange_weak(
+					pos, pos + 1u, std::memory_order_relaxed
+				)) {
+					break;
+				}
+			} else if (0 > diff) {
+				// Full
+				if (DeferPolicy::block != policy) {
+					if (DeferPolicy::count == policy) {
+						this->m_overflow.fetch_add(1u, std::memory_order_relaxed);
+					}
+					return false;
+				}
+				std::this_thread::yield();
+				pos = this->m_enqueue.load(std::memory_order_relaxed);
+			} else {
+				pos = this->m_enqueue.load(std::memory_order_relaxed);
+			}
+		}
+		bool truncated = false;
+		cell->render = fill(cell->payload, truncated);
+		cell->sequence.store(pos + 1u, std::memory_order_release);
+		if (truncated) {
+			this->m_truncated.fetch_add(1u, std::memory_order_relaxed);
+		}
+		return true;
+	}
+
+	/**
+		Render all queued records.
+
+		@returns Number of records rendered.
+		@param f Function called with a StringView of each rendered
+		record.
+	*/
+	template<class F>
+	std::size_t
+	drain(
+		F&& f
+	) {
+		String scratch;
+		std::size_t count = 0u;
+		for (;; ++count) {
+			scratch.clear();
+			if (!render_next(scratch)) {
+				break;
+			}
+			f(StringView(scratch.data(), scratch.size()));
+		}
+		return count;
+	}
+
+	/**
+		Render all queued records to stream.
+
+		@returns Number of records rendered.
+		@param stream Stream to write to.
+	*/
+	std::size_t
+	drain_to(
+		std::ostream& stream
+	) {
+		return drain([&stream](StringView const str) {
+			stream.write(str.data(), static_cast<std::streamsize>(str.size()));
+		});
+	}
+
+	/**
+		Get number of records discarded due to a full queue.
+
+		@note This is only counted with DeferPolicy::count.
+
+		@returns Number of discarded records.
+	*/
+	std::size_t
+	overflow_count() const noexcept {
+		return this->m_overflow.load(std::memory_order_relaxed);
+	}
+
+	/**
+		Get number of enqueued records with strings truncated to fit
+		the record payload.
+
+		@returns Number of truncated records.
+	*/
+	std::size_t
+	truncated_count() const noexcept {
+		return this->m_truncated.load(std::memory_order_relaxed);
+	}
+};
+
+template<
+	std::size_t capacity,
+	DeferPolicy policy,
+	std::size_t record_size
+>
+constexpr std::size_t const
+DeferQueue<capacity, policy, record_size>::payload_size;
+
+/**
+	Capture arguments for rendering by a consumer of @a queue.
+
+	@remarks Only the captured argument values (see defer_capture) are
+	copied, and no allocation is made. Strings are copied into the
+	record after the arguments and are truncated to fit the record,
+	which is counted by DeferQueue::truncated_count(). A null
+	C-string is captured as an empty string.
+
+	@returns @c true if the record was enqueued (see
+	DeferQueue::enqueue()).
+	@tparam format %Format.
+	@tparam ...ArgP Argument pack.
+	@param queue DeferQueue.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class Queue,
+	class... ArgP
+>
+inline bool
+defer(
+	Queue& queue,
+	ArgP const&... args
+) {
+	check_args<format, ArgP const&...>();
+	static_assert(
+		detail::defer_capturable<ArgP const&...>::value,
+		"object arguments to defer() require defer_ref() or a defer_capture specialization"
+	);
+	using Pack = detail::DeferPack<
+		typename detail::defer_captured<ArgP const&>::type...
+	>;
+	static_assert(
+		std::is_trivially_copyable<Pack>::value,
+		"captured arguments must be trivially copyable"
+	);
+	static_assert(
+		Queue::payload_size >= sizeof(Pack),
+		"captured arguments do not fit in the record payload"
+	);
+	return queue.enqueue([&args...](
+		unsigned char* const payload,
+		bool& truncated
+	) {
+		detail::DeferWriter writer{
+			payload, sizeof(Pack), Queue::payload_size, false
+		};
+		::new(static_cast<void*>(payload)) Pack(detail::defer_pack(writer, args...));
+		truncated = writer.truncated;
+		return &defer_render<format, Pack>;
+	});
+}
+
+/**
+	Background consumer of a DeferQueue.
+
+	Renders records to a stream on its own thread until destroyed.
+	Remaining records are rendered before destruction completes.
+*/
+template<class Queue>
+class DeferConsumer final {
+	Queue& m_queue;
+	std::ostream& m_stream;
+	std::chrono::microseconds const m_idle;
+	std::atomic<bool> m_stop;
+	std::thread m_thread;
+
+	void
+	run() {
+		while (!this->m_stop.load(std::memory_order_acquire)) {
+			if (0u == this->m_queue.drain_to(this->m_stream)) {
+				std::this_thread::sleep_for(this->m_idle);
+			}
+		}
+		this->m_queue.drain_to(this->m_stream);
+	}
+
+public:
+	DeferConsumer(DeferConsumer const&) = delete;
+	DeferConsumer& operator=(DeferConsumer const&) = delete;
+
+	/**
+		Start consumer.
+
+		@param queue Queue to consume.
+		@param stream Stream to write to.
+		@param idle Time to sleep when @a queue is empty.
+	*/
+	DeferConsumer(
+		Queue& queue,
+		std::ostream& stream,
+		std::chrono::microseconds const idle = std::chrono::microseconds(100)
+	)
+		: m_queue(queue)
+		, m_stream(stream)
+		, m_idle(idle)
+		, m_stop(false)
+		, m_thread(&DeferConsumer::run, this)
+	{}
+
+	/** Stop consumer after rendering remaining records. */
+	~DeferConsumer() {
+		this->m_stop.store(true, std::memory_order_release);
+		this->m_thread.join();
+	}
+};
+
+/** @} */ // end of doc-group print
+
+} // namespace ceformat
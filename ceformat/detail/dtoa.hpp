@@ -0,0 +1,539 @@
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+
+@file
+@brief Shortest floating-point digit generation.
+*/
+
+#pragma once
+
+#include <ceformat/config.hpp>
+
+#include <type_traits>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+namespace ceformat {
+namespace detail {
+namespace dtoa {
+
+// NB: This is Grisu3 (Loitsch, "Printing Floating-Point Numbers
+// Quickly and Accurately with Integers", 2010), which either yields
+// the shortest digits closest to the value or rejects it (about 0.5%
+// of doubles). Rejected values take the exact path, which finds the
+// shortest correctly rounded digits through the C library. Digit
+// generation is for the type of the value, so floats yield the
+// shortest digits for a float.
+
+struct diyfp final {
+	std::uint64_t f;
+	signed e;
+};
+
+inline diyfp
+sub(
+	diyfp const x,
+	diyfp const y
+) noexcept {
+	return diyfp{x.f - y.f, x.e};
+}
+
+// Upper 64 bits of the 128-bit product, rounded
+inline diyfp
+mul(
+	diyfp const x,
+	diyfp const y
+) noexcept {
+	std::uint64_t const u_lo = x.f & 0xFFFFFFFFu;
+	std::uint64_t const u_hi = x.f >> 32u;
+	std::uint64_t const v_lo = y.f & 0xFFFFFFFFu;
+	std::uint64_t const v_hi = y.f >> 32u;
+
+	std::uint64_t const p0 = u_lo * v_lo;
+	std::uint64_t const p1 = u_lo * v_hi;
+	std::uint64_t const p2 = u_hi * v_lo;
+	std::uint64_t const p3 = u_hi * v_hi;
+
+	std::uint64_t const q
+		= (p0 >> 32u)
+		+ (p1 & 0xFFFFFFFFu)
+		+ (p2 & 0xFFFFFFFFu)
+		+ (std::uint64_t{1u} << 31u) // round
+	;
+	return diyfp{
+		p3 + (p1 >> 32u) + (p2 >> 32u) + (q >> 32u),
+		x.e + y.e + 64
+	};
+}
+
+inline diyfp
+normalize(
+	diyfp x
+) noexcept {
+	while (0u == (x.f >> 63u)) {
+		x.f <<= 1u;
+		--x.e;
+	}
+	return x;
+}
+
+inline diyfp
+normalize_to(
+	diyfp const x,
+	signed const e
+) noexcept {
+	return diyfp{x.f << static_cast<unsigned>(x.e - e), e};
+}
+
+struct Boundaries final {
+	diyfp w;
+	diyfp minus;
+	diyfp plus;
+};
+
+// Normalized value and the boundaries of its rounding interval
+template<class V>
+inline Boundaries
+boundaries(
+	V const value
+) noexcept {
+	using bits_type = typename std::conditional<
+		sizeof(V) == sizeof(std::uint32_t),
+		std::uint32_t,
+		std::uint64_t
+	>::type;
+	static_assert(
+		sizeof(V) == sizeof(bits_type),
+		"floating-point type has unexpected size"
+	);
+
+	// including the hidden bit
+	constexpr signed const precision = std::numeric_limits<V>::digits;
+	constexpr signed const bias
+		= std::numeric_limits<V>::max_exponent - 1 + (precision - 1);
+	constexpr std::uint64_t const hidden_bit
+		= std::uint64_t{1u} << (precision - 1);
+
+	bits_type bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	std::uint64_t const f = bits & (hidden_bit - 1u);
+	std::uint64_t const e = bits >> (precision - 1);
+
+	diyfp const v
+		= 0u == e
+		? diyfp{f, 1 - bias}
+		: diyfp{f + hidden_bit, static_cast<signed>(e) - bias}
+	;
+	bool const lower_closer = 0u == f && 1u < e;
+	diyfp const m_plus = normalize(diyfp{2u * v.f + 1u, v.e - 1});
+	diyfp const m_minus
+		= lower_closer
+		? diyfp{4u * v.f - 1u, v.e - 2}
+		: diyfp{2u * v.f - 1u, v.e - 1}
+	;
+	return Boundaries{
+		normalize(v),
+		normalize_to(m_minus, m_plus.e),
+		m_plus
+	};
+}
+
+struct CachedPower final {
+	std::uint64_t f;
+	signed e;
+	signed k;
+};
+
+enum : signed {
+	// Range of binary exponents for digit generation
+	EXP_ALPHA = -60,
+	EXP_GAMMA = -32,
+
+	CACHED_MIN_DEC_EXP = -300,
+	CACHED_DEC_STEP = 8
+};
+
+// c = f * 2^e ~= 10^k, for k = -300, -292, ..., 324
+static constexpr CachedPower const
+s_cached_powers[]{
+	{0xAB70FE17C79AC6CA, -1060, -300},
+	{0xFF77B1FCBEBCDC4F, -1034, -292},
+	{0xBE5691EF416BD60C, -1007, -284},
+	{0x8DD01FAD907FFC3C, -980, -276},
+	{0xD3515C2831559A83, -954, -268},
+	{0x9D71AC8FADA6C9B5, -927, -260},
+	{0xEA9C227723EE8BCB, -901, -252},
+	{0xAECC49914078536D, -874, -244},
+	{0x823C12795DB6CE57, -847, -236},
+	{0xC21094364DFB5637, -821, -228},
+	{0x9096EA6F3848984F, -794, -220},
+	{0xD77485CB25823AC7, -768, -212},
+	{0xA086CFCD97BF97F4, -741, -204},
+	{0xEF340A98172AACE5, -715, -196},
+	{0xB23867FB2A35B28E, -688, -188},
+	{0x84C8D4DFD2C63F3B, -661, -180},
+	{0xC5DD44271AD3CDBA, -635, -172},
+	{0x936B9FCEBB25C996, -608, -164},
+	{0xDBAC6C247D62A584, -582, -156},
+	{0xA3AB66580D5FDAF6, -555, -148},
+	{0xF3E2F893DEC3F126, -529, -140},
+	{0xB5B5ADA8AAFF80B8, -502, -132},
+	{0x87625F056C7C4A8B, -475, -124},
+	{0xC9BCFF6034C13053, -449, -116},
+	{0x964E858C91BA2655, -422, -108},
+	{0xDFF9772470297EBD, -396, -100},
+	{0xA6DFBD9FB8E5B88F, -369, -92},
+	{0xF8A95FCF88747D94, -343, -84},
+	{0xB94470938FA89BCF, -316, -76},
+	{0x8A08F0F8BF0F156B, -289, -68},
+	{0xCDB02555653131B6, -263, -60},
+	{0x993FE2C6D07B7FAC, -236, -52},
+	{0xE45C10C42A2B3B06, -210, -44},
+	{0xAA242499697392D3, -183, -36},
+	{0xFD87B5F28300CA0E, -157, -28},
+	{0xBCE5086492111AEB, -130, -20},
+	{0x8CBCCC096F5088CC, -103, -12},
+	{0xD1B71758E219652C, -77, -4},
+	{0x9C40000000000000, -50, 4},
+	{0xE8D4A51000000000, -24, 12},
+	{0xAD78EBC5AC620000, 3, 20},
+	{0x813F3978F8940984, 30, 28},
+	{0xC097CE7BC90715B3, 56, 36},
+	{0x8F7E32CE7BEA5C70, 83, 44},
+	{0xD5D238A4ABE98068, 109, 52},
+	{0x9F4F2726179A2245, 136, 60},
+	{0xED63A231D4C4FB27, 162, 68},
+	{0xB0DE65388CC8ADA8, 189, 76},
+	{0x83C7088E1AAB65DB, 216, 84},
+	{0xC45D1DF942711D9A, 242, 92},
+	{0x924D692CA61BE758, 269, 100},
+	{0xDA01EE641A708DEA, 295, 108},
+	{0xA26DA3999AEF774A, 322, 116},
+	{0xF209787BB47D6B85, 348, 124},
+	{0xB454E4A179DD1877, 375, 132},
+	{0x865B86925B9BC5C2, 402, 140},
+	{0xC83553C5C8965D3D, 428, 148},
+	{0x952AB45CFA97A0B3, 455, 156},
+	{0xDE469FBD99A05FE3, 481, 164},
+	{0xA59BC234DB398C25, 508, 172},
+	{0xF6C69A72A3989F5C, 534, 180},
+	{0xB7DCBF5354E9BECE, 561, 188},
+	{0x88FCF317F22241E2, 588, 196},
+	{0xCC20CE9BD35C78A5, 614, 204},
+	{0x98165AF37B2153DF, 641, 212},
+	{0xE2A0B5DC971F303A, 667, 220},
+	{0xA8D9D1535CE3B396, 694, 228},
+	{0xFB9B7CD9A4A7443C, 720, 236},
+	{0xBB764C4CA7A44410, 747, 244},
+	{0x8BAB8EEFB6409C1A, 774, 252},
+	{0xD01FEF10A657842C, 800, 260},
+	{0x9B10A4E5E9913129, 827, 268},
+	{0xE7109BFBA19C0C9D, 853, 276},
+	{0xAC2820D9623BF429, 880, 284},
+	{0x80444B5E7AA7CF85, 907, 292},
+	{0xBF21E44003ACDD2D, 933, 300},
+	{0x8E679C2F5E44FF8F, 960, 308},
+	{0xD433179D9C8CB841, 986, 316},
+	{0x9E19DB92B4E31BA9, 1013, 324}
+};
+
+inline CachedPower const&
+cached_power(
+	signed const e
+) noexcept {
+	// k = ceil((EXP_ALPHA - e - 1) * log10(2))
+	signed const f = EXP_ALPHA - e - 1;
+	signed const k = (f * 78913) / (1 << 18) + static_cast<signed>(0 < f);
+	signed const index
+		= (-CACHED_MIN_DEC_EXP + k + (CACHED_DEC_STEP - 1))
+		/ CACHED_DEC_STEP
+	;
+	return s_cached_powers[index];
+}
+
+// Largest power of ten not exceeding n; yields its digit count
+inline signed
+largest_pow10(
+	std::uint32_t const n,
+	std::uint32_t& pow10
+) noexcept {
+	std::uint32_t p = 1000000000u;
+	signed count = 10;
+	while (1 < count && n < p) {
+		p /= 10u;
+		--count;
+	}
+	pow10 = p;
+	return count;
+}
+
+// Move the last digit towards w while staying in the interval; fails
+// if the digits can't be proven closest, or within the interval
+inline bool
+round_weed(
+	char* const digits,
+	signed const length,
+	std::uint64_t const dist,
+	std::uint64_t const unsafe,
+	std::uint64_t rest,
+	std::uint64_t const ten_k,
+	std::uint64_t const unit
+) noexcept {
+	std::uint64_t const dist_small = dist - unit;
+	std::uint64_t const dist_big = dist + unit;
+	while (
+		rest < dist_small &&
+		unsafe - rest >= ten_k &&
+		(
+			rest + ten_k < dist_small ||
+			dist_small - rest >= rest + ten_k - dist_small
+		)
+	) {
+		--digits[length - 1];
+		rest += ten_k;
+	}
+	if (
+		rest < dist_big &&
+		unsafe - rest >= ten_k &&
+		(
+			rest + ten_k < dist_big ||
+			dist_big - rest > rest + ten_k - dist_big
+		)
+	) {
+		return false;
+	}
+	return 2u * unit <= rest && rest <= unsafe - 4u * unit;
+}
+
+inline bool
+generate(
+	char* const digits,
+	signed& length,
+	signed& exponent,
+	diyfp const w_minus,
+	diyfp const w,
+	diyfp const w_plus
+) noexcept {
+	// The interval widened by the error of mul(); digits inside
+	// [w_minus + unit, w_plus - unit] are safe
+	std::uint64_t unit = 1u;
+	diyfp const too_low{w_minus.f - unit, w_minus.e};
+	diyfp const too_high{w_plus.f + unit, w_plus.e};
+	std::uint64_t unsafe = sub(too_high, too_low).f;
+	std::uint64_t const dist = sub(too_high, w).f;
+
+	unsigned const shift = static_cast<unsigned>(-w.e);
+	std::uint64_t const one = std::uint64_t{1u} << shift;
+
+	std::uint32_t p1 = static_cast<std::uint32_t>(too_high.f >> shift);
+	std::uint64_t p2 = too_high.f & (one - 1u);
+
+	// Integral digits
+	std::uint32_t pow10;
+	signed n = largest_pow10(p1, pow10);
+	while (0 < n) {
+		digits[length++] = static_cast<char>('0' + p1 / pow10);
+		p1 %= pow10;
+		--n;
+
+		std::uint64_t const rest = (std::uint64_t{p1} << shift) + p2;
+		if (rest < unsafe) {
+			exponent += n;
+			return round_weed(
+				digits, length, dist, unsafe, rest,
+				std::uint64_t{pow10} << shift, unit
+			);
+		}
+		pow10 /= 10u;
+	}
+
+	// Fractional digits
+	for (;;) {
+		p2 *= 10u;
+		unit *= 10u;
+		unsafe *= 10u;
+		digits[length++] = static_cast<char>('0' + (p2 >> shift));
+		p2 &= one - 1u;
+		--exponent;
+		if (p2 < unsafe) {
+			return round_weed(
+				digits, length, dist * unit, unsafe, p2, one, unit
+			);
+		}
+	}
+}
+
+/*
+	Generate shortest digits with Grisu3.
+
+	value must be positive and finite. Yields false if the value is
+	rejected; otherwise digits receives at most 17 characters (not
+	terminated), and the value is digits * 10^exponent.
+*/
+template<class V>
+inline bool
+grisu3(
+	char* const digits,
+	signed& length,
+	signed& exponent,
+	V const value
+) noexcept {
+	Boundaries const b = boundaries(value);
+	CachedPower const& cached = cached_power(b.plus.e);
+	diyfp const c{cached.f, cached.e};
+
+	length = 0;
+	exponent = -cached.k;
+	return generate(
+		digits, length, exponent,
+		mul(b.minus, c),
+		mul(b.w, c),
+		mul(b.plus, c)
+	);
+}
+
+inline double
+parse(
+	char const* const string,
+	double const /*tag*/
+) noexcept {
+	return std::strtod(string, nullptr);
+}
+
+inline float
+parse(
+	char const* const string,
+	float const /*tag*/
+) noexcept {
+	return std::strtof(string, nullptr);
+}
+
+// Bitwise equality, so exact comparison is explicit
+template<class V>
+inline bool
+same(
+	V const x,
+	V const y
+) noexcept {
+	return 0 == std::memcmp(&x, &y, sizeof(V));
+}
+
+// Value of digits * 10^exponent
+template<class V>
+inline V
+parse_digits(
+	char const* const digits,
+	signed const length,
+	signed const exponent
+) noexcept {
+	char string[48u];
+	std::memcpy(string, digits, static_cast<std::size_t>(length));
+	std::snprintf(
+		string + length, sizeof(string) - static_cast<std::size_t>(length),
+		"e%d", exponent
+	);
+	return parse(string, V{});
+}
+
+/*
+	Generate shortest digits exactly.
+
+	For each digit count, the correctly rounded digits are tried,
+	then their neighbour on the other side of the value (the interval
+	is asymmetric at powers of two). The first digits which read back
+	as the value are the shortest; digit counts can be tried in order,
+	since appending a zero keeps a value.
+*/
+template<class V>
+inline void
+exact(
+	char* const digits,
+	signed& length,
+	signed& exponent,
+	V const value
+) noexcept {
+	char buffer[48u];
+	for (signed count = 1;; ++count) {
+		// d[.ddd]e±x
+		std::snprintf(
+			buffer, sizeof(buffer), "%.*e",
+			count - 1, static_cast<double>(value)
+		);
+		// NB: The decimal point is the locale's, so only digits are
+		// taken; there are at most count of them
+		char const* pos = buffer;
+		length = 0;
+		for (; '\0' != *pos && 'e' != *pos; ++pos) {
+			if ('0' <= *pos && '9' >= *pos && count > length) {
+				digits[length++] = *pos;
+			}
+		}
+		exponent = ('e' == *pos
+			? static_cast<signed>(std::strtol(pos + 1, nullptr, 10))
+			: 0
+		) - (length - 1);
+		V const rounded = parse_digits<V>(digits, length, exponent);
+		// max_digits10 digits always read back as the value; the bound
+		// only guards against a C library which rounds badly
+		if (
+			same(value, rounded) ||
+			std::numeric_limits<V>::max_digits10 <= count
+		) {
+			return;
+		}
+
+		char neighbour[24u];
+		std::memcpy(neighbour, digits, static_cast<std::size_t>(length));
+		signed i = length - 1;
+		if (value > rounded) {
+			for (; 0 <= i && '9' == neighbour[i]; --i) {
+				neighbour[i] = '0';
+			}
+			if (0 > i) {
+				// 99..9 + 1; the single digit was tried with fewer digits
+				continue;
+			}
+			++neighbour[i];
+		} else {
+			for (; 0 <= i && '0' == neighbour[i]; --i) {
+				neighbour[i] = '9';
+			}
+			--neighbour[i];
+			if ('0' == neighbour[0]) {
+				// Fewer digits; tried before
+				continue;
+			}
+		}
+		if (same(value, parse_digits<V>(neighbour, length, exponent))) {
+			std::memcpy(digits, neighbour, static_cast<std::size_t>(length));
+			return;
+		}
+	}
+}
+
+/*
+	Generate shortest digits for value.
+
+	value must be positive and finite. digits receives at most 17
+	characters (not terminated); the value is
+	digits * 10^exponent.
+*/
+template<class V>
+inline void
+shortest(
+	char* const digits,
+	signed& length,
+	signed& exponent,
+	V const value
+) noexcept {
+	if (!grisu3(digits, length, exponent, value)) {
+		exact(digits, length, exponent, value);
+	}
+}
+
+} // namespace dtoa
+} // namespace detail
+} // namespace ceformat
@@ -0,0 +1,1124 @@
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+
+@file
+@brief Stream-free element kernels.
+*/
+
+#pragma once
+
+#include <ceformat/config.hpp>
+#include <ceformat/String.hpp>
+#include <ceformat/element_defs.hpp>
+#include <ceformat/utility.hpp>
+#include <ceformat/Format.hpp>
+#include <ceformat/sink.hpp>
+#include <ceformat/detail/type.hpp>
+#include <ceformat/detail/dtoa.hpp>
+
+#include <type_traits>
+#include <utility>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <clocale>
+#include <cmath>
+#include <ios>
+
+#if CEFORMAT_CONFIG_SIMD && defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+namespace ceformat {
+namespace detail {
+
+// NB: Kernels write to a sink (see sink.hpp).
+//
+// All kernels reproduce the output of write_element() for a stream
+// in its default state (classic locale, no user flags). Each
+// write_value() has a measure_value() counterpart which yields the
+// size of its output.
+
+template<class T>
+constexpr bool
+tte_character() noexcept {
+	return false
+	|| std::is_same<char, rm_cref_t<T>>::value
+	|| std::is_same<signed char, rm_cref_t<T>>::value
+	|| std::is_same<unsigned char, rm_cref_t<T>>::value
+	;
+}
+
+template<class T>
+constexpr bool
+tte_string_native() noexcept {
+	return
+	tte_string<T>() && (
+		tte_string_charwise<T>() ||
+		std::is_same<String, rm_cref_t<T>>::value ||
+		std::is_same<StringView, rm_cref_t<T>>::value
+	);
+}
+
+template<class T>
+constexpr bool
+tte_object() noexcept {
+	return
+	tte_string<T>() && !tte_string_native<T>();
+}
+
+template<class... T>
+struct any_object;
+
+template<>
+struct any_object<> {
+	static constexpr bool value = false;
+};
+
+template<class T, class... P>
+struct any_object<T, P...> {
+	static constexpr bool value
+		= tte_object<T>()
+		|| any_object<P...>::value
+	;
+};
+
+namespace {
+
+static constexpr char const
+s_digits_lower[] = "0123456789abcdef";
+
+// Pad data to element width. Numeric output is padded like
+// std::num_put (internal adjustment after sign or base prefix);
+// all other output is padded like std::__ostream_insert().
+template<class Sink>
+inline void
+write_padded(
+	Sink& sink,
+	Element const& element,
+	char const* const data,
+	std::size_t const size,
+	bool const numeric
+) {
+	if (element.width <= size) {
+		sink.append(data, size);
+		return;
+	}
+
+	std::size_t const fill_size = element.width - size;
+	char const fill
+		= element.has_flag(ElementFlags::zero_padded)
+		? '0'
+		: ' '
+	;
+	if (element.has_flag(ElementFlags::left_align)) {
+		sink.append(data, size);
+		sink.append(fill, fill_size);
+		return;
+	}
+
+	std::size_t prefix = 0u;
+	if (!numeric || 0u == size) {
+		// no prefix
+	} else if ('-' == data[0] || '+' == data[0]) {
+		prefix = 1u;
+	} else if (
+		1u < size && '0' == data[0] &&
+		('x' == data[1] || 'X' == data[1])
+	) {
+		prefix = 2u;
+	}
+	sink.append(data, prefix);
+	sink.append(fill, fill_size);
+	sink.append(data + prefix, size - prefix);
+}
+
+// Pad data which outlives the output (see append_ref()) like
+// non-numeric output
+template<class Sink>
+inline void
+write_padded_ref(
+	Sink& sink,
+	Element const& element,
+	char const* const data,
+	std::size_t const size
+) {
+	if (element.width <= size) {
+		append_ref(sink, data, size);
+		return;
+	}
+	std::size_t const fill_size = element.width - size;
+	char const fill
+		= element.has_flag(ElementFlags::zero_padded)
+		? '0'
+		: ' '
+	;
+	if (element.has_flag(ElementFlags::left_align)) {
+		append_ref(sink, data, size);
+		sink.append(fill, fill_size);
+	} else {
+		sink.append(fill, fill_size);
+		append_ref(sink, data, size);
+	}
+}
+
+inline std::size_t
+measure_padded(
+	Element const& element,
+	std::size_t const size
+) noexcept {
+	return
+		element.width > size
+		? element.width
+		: size
+	;
+}
+
+// Decimal digit pairs "00" through "99"
+static constexpr char const
+s_digits_pairs[]
+	= "00010203040506070809"
+	  "10111213141516171819"
+	  "20212223242526272829"
+	  "30313233343536373839"
+	  "40414243444546474849"
+	  "50515253545556575859"
+	  "60616263646566676869"
+	  "70717273747576777879"
+	  "80818283848586878889"
+	  "90919293949596979899"
+;
+
+// NB: Digit writers fill backwards from pos and return the position
+// of the first digit.
+
+template<class U>
+inline char*
+write_decimal(
+	char* pos,
+	U value
+) noexcept {
+	while (100u <= value) {
+		unsigned const index = static_cast<unsigned>(value % 100u) * 2u;
+		value /= 100u;
+		*--pos = s_digits_pairs[index + 1u];
+		*--pos = s_digits_pairs[index];
+	}
+	if (10u <= value) {
+		unsigned const index = static_cast<unsigned>(value) * 2u;
+		*--pos = s_digits_pairs[index + 1u];
+		*--pos = s_digits_pairs[index];
+	} else {
+		*--pos = static_cast<char>('0' + static_cast<unsigned>(value));
+	}
+	return pos;
+}
+
+template<
+	unsigned shift,
+	class U
+>
+inline char*
+write_pow2(
+	char* pos,
+	U value
+) noexcept {
+	do {
+		*--pos = s_digits_lower[value & ((1u << shift) - 1u)];
+		value >>= shift;
+	} while (0u != value);
+	return pos;
+}
+
+// Number of hexadecimal digits in value
+inline unsigned
+hex_digit_count(
+	std::uint64_t const value
+) noexcept {
+#if defined(__GNUC__)
+	return (67u - static_cast<unsigned>(__builtin_clzll(value | 1u))) / 4u;
+#else
+	return utility::digit_count(value, 16u);
+#endif
+}
+
+// Write all 16 hexadecimal digits of value to out
+inline void
+write_hex16(
+	char* const out,
+	std::uint64_t const value
+) noexcept {
+#if CEFORMAT_CONFIG_SIMD && defined(__SSE2__)
+	// Most significant byte first
+	unsigned char bytes[8u];
+	for (unsigned i = 0u; 8u > i; ++i) {
+		bytes[i] = static_cast<unsigned char>(value >> (56u - 8u * i));
+	}
+	__m128i const x = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(bytes));
+	__m128i const low_mask = _mm_set1_epi8(0x0F);
+	__m128i const nibbles = _mm_unpacklo_epi8(
+		_mm_and_si128(_mm_srli_epi64(x, 4), low_mask),
+		_mm_and_si128(x, low_mask)
+	);
+	// '0' + n, plus the distance from '9' + 1 to 'a' for n > 9
+	__m128i const letters = _mm_and_si128(
+		_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)),
+		_mm_set1_epi8('a' - '0' - 10)
+	);
+	_mm_storeu_si128(
+		reinterpret_cast<__m128i*>(out),
+		_mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters)
+	);
+#else
+	for (unsigned i = 0u; 16u > i; ++i) {
+		out[15u - i] = s_digits_lower[(value >> (4u * i)) & 0x0Fu];
+	}
+#endif
+}
+
+template<class U>
+inline char*
+write_hex(
+	char* pos,
+	U const value
+) noexcept {
+	static_assert(
+		sizeof(std::uint64_t) >= sizeof(U),
+		"hexadecimal kernel only supports up to 64-bit values"
+	);
+	char digits[16u];
+	write_hex16(digits, value);
+	unsigned const count = hex_digit_count(value);
+	pos -= count;
+	std::memcpy(pos, digits + 16u - count, count);
+	return pos;
+}
+
+// integral
+
+template<class T>
+inline void
+write_integer(
+	char*& pos,
+	ElementType const type,
+	bool const alternative,
+	bool const show_sign,
+	T const value
+) noexcept {
+	using U = typename std::make_unsigned<T>::type;
+	switch (type) {
+	case ElementType::hex:
+	case ElementType::ptr:
+		pos = write_hex(pos, static_cast<U>(value));
+		if (alternative && 0 != value) {
+			*--pos = 'x';
+			*--pos = '0';
+		}
+		break;
+
+	case ElementType::oct:
+		pos = write_pow2<3u>(pos, static_cast<U>(value));
+		if (alternative && 0 != value) {
+			*--pos = '0';
+		}
+		break;
+
+	default:
+		if (std::is_signed<T>::value && 0 > value) {
+			pos = write_decimal(pos, static_cast<U>(U(0u) - static_cast<U>(value)));
+			*--pos = '-';
+		} else {
+			pos = write_decimal(pos, static_cast<U>(value));
+			if (std::is_signed<T>::value && show_sign) {
+				*--pos = '+';
+			}
+		}
+		break;
+	}
+}
+
+template<class T>
+inline std::size_t
+measure_integer(
+	ElementType const type,
+	bool const alternative,
+	bool const show_sign,
+	T const value
+) noexcept {
+	using U = typename std::make_unsigned<T>::type;
+	switch (type) {
+	case ElementType::hex:
+	case ElementType::ptr:
+		return
+			utility::digit_count(static_cast<U>(value), 16u)
+			+ ((alternative && 0 != value) ? 2u : 0u)
+		;
+
+	case ElementType::oct:
+		return
+			utility::digit_count(static_cast<U>(value), 8u)
+			+ ((alternative && 0 != value) ? 1u : 0u)
+		;
+
+	default:
+		if (std::is_signed<T>::value && 0 > value) {
+			return 1u + utility::digit_count(
+				static_cast<U>(U(0u) - static_cast<U>(value))
+			);
+		} else {
+			return
+				utility::digit_count(static_cast<U>(value))
+				+ ((std::is_signed<T>::value && show_sign) ? 1u : 0u)
+			;
+		}
+	}
+}
+
+template<class T>
+inline typename std::enable_if<
+	tte_integral<T>() && !tte_character<T>(),
+	std::size_t
+>::type
+measure_value(
+	Element const& element,
+	char const /*spec*/,
+	T&& value
+) noexcept {
+	return measure_padded(element, measure_integer<rm_cref_t<T>>(
+		element.type,
+		element.has_flag(ElementFlags::alternative),
+		element.has_flag(ElementFlags::show_sign),
+		value
+	));
+}
+
+template<class Sink, class T>
+inline typename std::enable_if<
+	tte_integral<T>() && !tte_character<T>()
+>::type
+write_value(
+	Sink& sink,
+	Element const& element,
+	char const /*spec*/,
+	T&& value
+) {
+	using V = rm_cref_t<T>;
+	// octal digits of the widest value, plus sign or base prefix
+	char buffer[(CHAR_BIT * sizeof(V) + 2u) / 3u + 2u];
+	char* const end = buffer + sizeof(buffer);
+	char* pos = end;
+	write_integer<V>(
+		pos,
+		element.type,
+		element.has_flag(ElementFlags::alternative),
+		element.has_flag(ElementFlags::show_sign),
+		value
+	);
+	write_padded(sink, element, pos, static_cast<std::size_t>(end - pos), true);
+}
+
+// character (including as integral; std::ostream writes these as text)
+
+template<class T>
+inline typename std::enable_if<
+	tte_character<T>(),
+	std::size_t
+>::type
+measure_value(
+	Element const& element,
+	char const /*spec*/,
+	T&& /*value*/
+) noexcept {
+	return measure_padded(element, 1u);
+}
+
+template<class Sink, class T>
+inline typename std::enable_if<
+	tte_character<T>()
+>::type
+write_value(
+	Sink& sink,
+	Element const& element,
+	char const /*spec*/,
+	T&& value
+) {
+	char const c = static_cast<char>(value);
+	write_padded(sink, element, &c, 1u, false);
+}
+
+// floating-point
+
+// NB: std::ostream and printf promote float to double
+template<class T>
+using float_promote_t = typename std::conditional<
+	std::is_same<long double, rm_cref_t<T>>::value,
+	long double,
+	double
+>::type;
+
+struct FloatSpec final {
+	char format[8u];
+	signed precision;
+};
+
+// printf-style conversion matching std::num_put for the element
+template<class V>
+inline FloatSpec
+float_spec(
+	Element const& element,
+	char const spec
+) noexcept {
+	FloatSpec fs;
+	char* f = fs.format;
+	*f++ = '%';
+	if (element.has_flag(ElementFlags::show_sign)) {
+		*f++ = '+';
+	}
+	if (element.has_flag(ElementFlags::alternative)) {
+		*f++ = '#';
+	}
+	*f++ = '.';
+	*f++ = '*';
+	if (std::is_same<long double, V>::value) {
+		*f++ = 'L';
+	}
+	*f++ = ('e' == spec || 'g' == spec) ? spec : 'f';
+	*f = '\0';
+	fs.precision
+		= -1 != element.precision
+		? static_cast<signed>(element.precision)
+		: 6
+	;
+	return fs;
+}
+
+// Whether the element yields the shortest round-trip representation
+// (%g without precision or alternative form)
+constexpr bool
+float_shortest(
+	Element const& element,
+	char const spec
+) noexcept {
+	return
+		'g' == spec &&
+		-1 == element.precision &&
+		!element.has_flag(ElementFlags::alternative)
+	;
+}
+
+// NB: Digits rounded to at most this many significant digits are
+// exact when taken from the shortest representation of a double.
+enum : signed {
+	FLOAT_EXACT_DIGITS = 15,
+	FLOAT_BUFFER_SIZE = 128
+};
+
+// Significant digits of a value; value = d.ddd * 10^exponent
+struct FloatDigits final {
+	char digits[24u];
+	signed count;
+	signed exponent;
+};
+
+template<class V>
+inline void
+float_digits(
+	FloatDigits& fd,
+	V const value
+) noexcept {
+	if (FP_ZERO == std::fpclassify(value)) {
+		fd.digits[0] = '0';
+		fd.count = 1;
+		fd.exponent = 0;
+		return;
+	}
+	signed exponent;
+	dtoa::shortest(fd.digits, fd.count, exponent, value);
+	while (1 < fd.count && '0' == fd.digits[fd.count - 1]) {
+		--fd.count;
+		++exponent;
+	}
+	fd.exponent = exponent + fd.count - 1;
+}
+
+inline char*
+float_fixed(
+	char* pos,
+	FloatDigits const& fd,
+	signed const fraction,
+	bool const point
+) noexcept {
+	if (0 > fd.exponent) {
+		*pos++ = '0';
+	} else {
+		for (signed i = 0; fd.exponent >= i; ++i) {
+			*pos++ = fd.count > i ? fd.digits[i] : '0';
+		}
+	}
+	if (0 < fraction || point) {
+		*pos++ = '.';
+	}
+	for (signed i = fd.exponent + 1; fd.exponent + fraction >= i; ++i) {
+		*pos++ = 0 <= i && fd.count > i ? fd.digits[i] : '0';
+	}
+	return pos;
+}
+
+inline char*
+float_scientific(
+	char* pos,
+	FloatDigits const& fd,
+	signed const fraction,
+	bool const point
+) noexcept {
+	*pos++ = fd.digits[0];
+	if (0 < fraction || point) {
+		*pos++ = '.';
+	}
+	for (signed i = 1; fraction >= i; ++i) {
+		*pos++ = fd.count > i ? fd.digits[i] : '0';
+	}
+	*pos++ = 'e';
+	*pos++ = 0 > fd.exponent ? '-' : '+';
+	unsigned const exponent = static_cast<unsigned>(
+		0 > fd.exponent ? -fd.exponent : fd.exponent
+	);
+	if (100u <= exponent) {
+		*pos++ = static_cast<char>('0' + exponent / 100u);
+	}
+	std::memcpy(pos, s_digits_pairs + 2u * (exponent % 100u), 2u);
+	return pos + 2;
+}
+
+/*
+	Render a finite value to buffer (FLOAT_BUFFER_SIZE) without
+	padding.
+
+	Yields the size of the output, or -1 if the value is not finite,
+	needs rounding that the shortest digits can't provide, or doesn't
+	fit, in which case the caller falls back to std::snprintf().
+*/
+template<class V>
+inline signed
+render_float(
+	char* const buffer,
+	Element const& element,
+	char const spec,
+	V value
+) noexcept {
+	if (!std::isfinite(value)) {
+		return -1;
+	}
+
+	bool const point = element.has_flag(ElementFlags::alternative);
+	char* pos = buffer;
+	if (std::signbit(value)) {
+		*pos++ = '-';
+		value = -value;
+	} else if (element.has_flag(ElementFlags::show_sign)) {
+		*pos++ = '+';
+	}
+
+	FloatDigits fd;
+	if (float_shortest(element, spec)) {
+		float_digits(fd, value);
+		if (-4 > fd.exponent || (6 > fd.count ? 6 : fd.count) <= fd.exponent) {
+			pos = float_scientific(pos, fd, fd.count - 1, false);
+		} else {
+			signed const fraction = fd.count - 1 - fd.exponent;
+			pos = float_fixed(pos, fd, 0 < fraction ? fraction : 0, false);
+		}
+		return static_cast<signed>(pos - buffer);
+	}
+
+	// Digits of the value as printf sees it (float is promoted).
+	// Subnormals lack the precision the exact digit bound relies on.
+	double const promoted = static_cast<double>(value);
+	if (FP_SUBNORMAL == std::fpclassify(promoted)) {
+		return -1;
+	}
+	float_digits(fd, promoted);
+	signed const precision
+		= -1 != element.precision
+		? static_cast<signed>(element.precision)
+		: 6
+	;
+	signed significant;
+	signed length;
+	if ('e' == spec) {
+		significant = precision + 1;
+		length = precision + 8;
+	} else if ('g' == spec) {
+		significant = 0 == precision ? 1 : precision;
+		length = significant + 8;
+	} else {
+		significant = fd.exponent + 1 + precision;
+		length = (0 > fd.exponent ? 1 : fd.exponent + 1) + 1 + precision;
+	}
+	if (
+		FLOAT_EXACT_DIGITS < significant ||
+		fd.count > significant ||
+		FLOAT_BUFFER_SIZE - 1 < length
+	) {
+		return -1;
+	}
+
+	if ('e' == spec) {
+		pos = float_scientific(pos, fd, precision, point);
+	} else if ('g' == spec) {
+		// NB: Without alternative form, trailing zeros are removed
+		if (-4 > fd.exponent || significant <= fd.exponent) {
+			pos = float_scientific(
+				pos, fd, point ? significant - 1 : fd.count - 1, point
+			);
+		} else {
+			signed const fraction
+				= point
+				? significant - 1 - fd.exponent
+				: fd.count - 1 - fd.exponent
+			;
+			pos = float_fixed(pos, fd, 0 < fraction ? fraction : 0, point);
+		}
+	} else {
+		pos = float_fixed(pos, fd, precision, point);
+	}
+	return static_cast<signed>(pos - buffer);
+}
+
+inline signed
+render_float(
+	char* const /*buffer*/,
+	Element const& /*element*/,
+	char const /*spec*/,
+	long double const /*value*/
+) noexcept {
+	return -1;
+}
+
+// NB: snprintf() uses the decimal point of the C locale, but output
+// is always in the classic locale
+inline signed
+float_classic_point(
+	char* const data,
+	signed const size
+) noexcept {
+	char const* const point = std::localeconv()->decimal_point;
+	std::size_t const point_size = std::strlen(point);
+	if (0u == point_size || ('.' == point[0u] && 1u == point_size)) {
+		return size;
+	}
+	char* const end = data + size;
+	for (char* pos = data; point_size <= static_cast<std::size_t>(end - pos); ++pos) {
+		if (0 == std::memcmp(pos, point, point_size)) {
+			*pos = '.';
+			std::memmove(
+				pos + 1, pos + point_size,
+				static_cast<std::size_t>(end - pos) - point_size
+			);
+			return size - static_cast<signed>(point_size - 1u);
+		}
+	}
+	return size;
+}
+
+template<class V>
+inline std::size_t
+measure_float(
+	Element const& element,
+	char const spec,
+	V const value
+) noexcept {
+	char buffer[FLOAT_BUFFER_SIZE];
+	signed const size = render_float(buffer, element, spec, value);
+	if (0 <= size) {
+		return measure_padded(element, static_cast<std::size_t>(size));
+	}
+
+	using P = float_promote_t<V>;
+	FloatSpec const fs = float_spec<P>(element, spec);
+	signed large_size = std::snprintf(
+		nullptr, 0u, fs.format, fs.precision, static_cast<P>(value)
+	);
+	if (0 > large_size) {
+		return 0u;
+	} else if (1u < std::strlen(std::localeconv()->decimal_point)) {
+		// Wider point; only large %f output doesn't fit, and it has a
+		// point if it has a fraction
+		char wide[2 * FLOAT_BUFFER_SIZE];
+		if (sizeof(wide) > static_cast<std::size_t>(large_size)) {
+			std::snprintf(
+				wide, sizeof(wide), fs.format, fs.precision, static_cast<P>(value)
+			);
+			large_size = float_classic_point(wide, large_size);
+		} else if (
+			std::isfinite(value) &&
+			(0 < fs.precision || element.has_flag(ElementFlags::alternative))
+		) {
+			large_size -= static_cast<signed>(
+				std::strlen(std::localeconv()->decimal_point) - 1u
+			);
+		}
+	}
+	return measure_padded(element, static_cast<std::size_t>(large_size));
+}
+
+template<class Sink, class V>
+inline void
+write_float(
+	Sink& sink,
+	Element const& element,
+	char const spec,
+	V const value
+) {
+	char buffer[FLOAT_BUFFER_SIZE];
+	signed size = render_float(buffer, element, spec, value);
+	if (0 <= size) {
+		write_padded(sink, element, buffer, static_cast<std::size_t>(size), true);
+		return;
+	}
+
+	using P = float_promote_t<V>;
+	FloatSpec const fs = float_spec<P>(element, spec);
+	size = std::snprintf(
+		buffer, sizeof(buffer), fs.format, fs.precision, static_cast<P>(value)
+	);
+	if (0 > size) {
+		return;
+	} else if (sizeof(buffer) > static_cast<std::size_t>(size)) {
+		size = float_classic_point(buffer, size);
+		write_padded(sink, element, buffer, static_cast<std::size_t>(size), true);
+	} else {
+		String large(static_cast<std::size_t>(size) + 1u, '\0');
+		std::snprintf(
+			&large[0], large.size(), fs.format, fs.precision, static_cast<P>(value)
+		);
+		size = float_classic_point(&large[0], size);
+		write_padded(sink, element, large.data(), static_cast<std::size_t>(size), true);
+	}
+}
+
+template<class T>
+inline typename std::enable_if<
+	tte_floating_point<T>(),
+	std::size_t
+>::type
+measure_value(
+	Element const& element,
+	char const spec,
+	T&& value
+) noexcept {
+	return measure_float<rm_cref_t<T>>(element, spec, value);
+}
+
+template<class Sink, class T>
+inline typename std::enable_if<
+	tte_floating_point<T>()
+>::type
+write_value(
+	Sink& sink,
+	Element const& element,
+	char const spec,
+	T&& value
+) {
+	write_float<Sink, rm_cref_t<T>>(sink, element, spec, value);
+}
+
+// boolean
+
+template<class T>
+inline typename std::enable_if<
+	tte_boolean<T>(),
+	std::size_t
+>::type
+measure_value(
+	Element const& element,
+	char const /*spec*/,
+	T&& value
+) noexcept {
+	return measure_padded(element, value ? 4u : 5u);
+}
+
+template<class Sink, class T>
+inline typename std::enable_if<
+	tte_boolean<T>()
+>::type
+write_value(
+	Sink& sink,
+	Element const& element,
+	char const /*spec*/,
+	T&& value
+) {
+	if (value) {
+		write_padded_ref(sink, element, "true", 4u);
+	} else {
+		write_padded_ref(sink, element, "false", 5u);
+	}
+}
+
+// pointer
+
+inline std::size_t
+measure_value(
+	Element const& element,
+	char const /*spec*/,
+	void const* const value
+) noexcept {
+	return measure_padded(element, measure_integer<std::uintptr_t>(
+		ElementType::ptr,
+		true,
+		false,
+		reinterpret_cast<std::uintptr_t>(value)
+	));
+}
+
+template<class Sink>
+inline void
+write_value(
+	Sink& sink,
+	Element const& element,
+	char const /*spec*/,
+	void const* const value
+) {
+	// NB: std::num_put always shows base for pointers
+	char buffer[2u * sizeof(std::uintptr_t) + 2u];
+	char* const end = buffer + sizeof(buffer);
+	char* pos = end;
+	write_integer<std::uintptr_t>(
+		pos,
+		ElementType::ptr,
+		true,
+		false,
+		reinterpret_cast<std::uintptr_t>(value)
+	);
+	write_padded(sink, element, pos, static_cast<std::size_t>(end - pos), true);
+}
+
+// string
+
+inline std::size_t
+measure_value(
+	Element const& element,
+	char const /*spec*/,
+	char const* const value
+) noexcept {
+	return
+		nullptr != value
+		? measure_padded(element, std::strlen(value))
+		: 0u
+	;
+}
+
+inline std::size_t
+measure_value(
+	Element const& element,
+	char const /*spec*/,
+	String const& value
+) noexcept {
+	return measure_padded(element, value.size());
+}
+
+inline std::size_t
+measure_value(
+	Element const& element,
+	char const /*spec*/,
+	StringView const value
+) noexcept {
+	return measure_padded(element, value.size());
+}
+
+template<class Sink>
+inline void
+write_value(
+	Sink& sink,
+	Element const& element,
+	char const /*spec*/,
+	char const* const value
+) {
+	if (nullptr != value) {
+		write_padded_ref(sink, element, value, std::strlen(value));
+	}
+}
+
+template<class Sink>
+inline void
+write_value(
+	Sink& sink,
+	Element const& element,
+	char const /*spec*/,
+	String const& value
+) {
+	write_padded_ref(sink, element, value.data(), value.size());
+}
+
+template<class Sink>
+inline void
+write_value(
+	Sink& sink,
+	Element const& element,
+	char const /*spec*/,
+	StringView const value
+) {
+	write_padded_ref(sink, element, value.data(), value.size());
+}
+
+// object
+
+template<class Sink, class T>
+inline typename std::enable_if<
+	tte_object<T>()
+>::type
+write_value(
+	Sink& sink,
+	Element const& element,
+	char const /*spec*/,
+	T&& value
+) {
+	OutputStringStream stream;
+	stream.setf(
+		element.has_flag(ElementFlags::left_align)
+			? std::ios_base::left
+			: std::ios_base::internal
+		,
+		std::ios_base::adjustfield
+	);
+	stream.fill(
+		element.has_flag(ElementFlags::zero_padded)
+			? '0'
+			: ' '
+	);
+	stream.width(static_cast<std::streamsize>(element.width));
+	stream << std::forward<T>(value);
+	String const str = stream.str();
+	sink.append(str.data(), str.size());
+}
+
+// NB: Objects can only be measured by rendering them
+template<class T>
+inline typename std::enable_if<
+	tte_object<T>(),
+	std::size_t
+>::type
+measure_value(
+	Element const& element,
+	char const spec,
+	T&& value
+) {
+	CountingSink sink{0u};
+	write_value(sink, element, spec, std::forward<T>(value));
+	return sink.size;
+}
+
+// fixed-width hexadecimal
+
+// Size of the base prefix of a hexadecimal element (std::num_put
+// always shows base for pointers)
+constexpr unsigned
+hex_fixed_prefix(
+	Element const& element
+) noexcept {
+	return
+		ElementType::ptr == element.type ||
+		element.has_flag(ElementFlags::alternative)
+		? 2u
+		: 0u
+	;
+}
+
+// Digits of a zero-padded hexadecimal element with a width of at most
+// 16 digits past its prefix, or 0 for any other element
+constexpr unsigned
+hex_fixed_digits(
+	Element const& element
+) noexcept {
+	return
+		(ElementType::hex == element.type || ElementType::ptr == element.type) &&
+		element.has_flag(ElementFlags::zero_padded) &&
+		!element.has_flag(ElementFlags::left_align) &&
+		hex_fixed_prefix(element) < element.width &&
+		hex_fixed_prefix(element) + 16u >= element.width
+		? static_cast<unsigned>(element.width) - hex_fixed_prefix(element)
+		: 0u
+	;
+}
+
+template<class T>
+constexpr bool
+tte_hex_fixed() noexcept {
+	return
+		(tte_integral<T>() && !tte_character<T>()) ||
+		std::is_same<void const*, rm_cref_t<T>>::value
+	;
+}
+
+template<class T>
+inline typename std::enable_if<
+	tte_integral<T>(),
+	std::uint64_t
+>::type
+hex_bits(
+	T const value
+) noexcept {
+	return static_cast<typename std::make_unsigned<T>::type>(value);
+}
+
+inline std::uint64_t
+hex_bits(
+	void const* const value
+) noexcept {
+	return reinterpret_cast<std::uintptr_t>(value);
+}
+
+// NB: digits is hex_fixed_digits() of the element. Values which fit
+// are written as exactly width characters; zero (which has no base
+// prefix) and wider values take the general path.
+template<
+	unsigned digits,
+	class Sink,
+	class T
+>
+inline typename std::enable_if<
+	0u != digits && tte_hex_fixed<T>()
+>::type
+write_fixed(
+	Sink& sink,
+	Element const& element,
+	char const spec,
+	T&& value
+) {
+	std::uint64_t const bits = hex_bits(value);
+	if (0u == bits || digits < hex_digit_count(bits)) {
+		write_value(sink, element, spec, std::forward<T>(value));
+		return;
+	}
+	char buffer[18u];
+	write_hex16(buffer + 2u, bits);
+	char* const pos = buffer + 18u - element.width;
+	if (0u != hex_fixed_prefix(element)) {
+		pos[0] = '0';
+		pos[1] = 'x';
+	}
+	sink.append(pos, element.width);
+}
+
+template<
+	unsigned digits,
+	class Sink,
+	class T
+>
+inline typename std::enable_if<
+	0u == digits || !tte_hex_fixed<T>()
+>::type
+write_fixed(
+	Sink& sink,
+	Element const& element,
+	char const spec,
+	T&& value
+) {
+	write_value(sink, element, spec, std::forward<T>(value));
+}
+
+} // anonymous namespace
+
+} // namespace detail
+} // namespace ceformat
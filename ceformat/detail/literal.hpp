@@ -0,0 +1,65 @@
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+
+@file
+@brief Literal text storage.
+*/
+
+#pragma once
+
+#include <ceformat/config.hpp>
+#include <ceformat/Format.hpp>
+#include <ceformat/detail/sequence.hpp>
+
+namespace ceformat {
+namespace detail {
+
+// Literal text with escapes collapsed; only instantiated for formats
+// that have escapes (otherwise the literal text is the format string)
+template<
+	Format const& format,
+	class = make_index_sequence<format.size - format.escape_count>
+>
+struct literal_storage;
+
+template<
+	Format const& format,
+	std::size_t... I
+>
+struct literal_storage<format, index_sequence<I...>> {
+	static constexpr char const data[sizeof...(I) + 1u]{
+		format.literal_char(I)...,
+		'\0'
+	};
+};
+
+template<
+	Format const& format,
+	std::size_t... I
+>
+constexpr char const
+literal_storage<format, index_sequence<I...>>::data[sizeof...(I) + 1u];
+
+template<
+	Format const& format,
+	bool = 0u != format.escape_count
+>
+struct literal_text {
+	static constexpr char const*
+	data() noexcept {
+		return format.string;
+	}
+};
+
+template<
+	Format const& format
+>
+struct literal_text<format, true> {
+	static constexpr char const*
+	data() noexcept {
+		return literal_storage<format>::data;
+	}
+};
+
+} // namespace detail
+} // namespace ceformat
@@ -0,0 +1,51 @@
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+
+@file
+@brief Compile-time index sequences.
+*/
+
+#pragma once
+
+#include <ceformat/config.hpp>
+
+namespace ceformat {
+namespace detail {
+
+// NB: C++11 lacks std::index_sequence. Construction is by halving,
+// so instantiation depth is logarithmic in N.
+
+template<std::size_t...>
+struct index_sequence {};
+
+template<class, class>
+struct index_sequence_join;
+
+template<std::size_t... I, std::size_t... J>
+struct index_sequence_join<index_sequence<I...>, index_sequence<J...>> {
+	using type = index_sequence<I..., (sizeof...(I) + J)...>;
+};
+
+template<std::size_t N>
+struct index_sequence_make {
+	using type = typename index_sequence_join<
+		typename index_sequence_make<N / 2u>::type,
+		typename index_sequence_make<N - N / 2u>::type
+	>::type;
+};
+
+template<>
+struct index_sequence_make<0u> {
+	using type = index_sequence<>;
+};
+
+template<>
+struct index_sequence_make<1u> {
+	using type = index_sequence<0u>;
+};
+
+template<std::size_t N>
+using make_index_sequence = typename index_sequence_make<N>::type;
+
+} // namespace detail
+} // namespace ceformat
@@ -118,7 +118,7 @@ tte_pointer() noexcept {
 		>::value ||
 		std::is_same<
 			std::nullptr_t,
-			rm_ref_t<T>
+			rm_cref_t<T>
 		>::value
 	)
 	;
@@ -322,13 +322,13 @@ struct type_check_impl<format, I, P...> {
 	) noexcept {
 		return false
 		|| !type_to_element<I>::valid
-		|| !type_to_element<I>::type_matches(format.elements[index].type)
+		|| !type_to_element<I>::type_matches(
+			format.elements[format.segments[index].element].type
+		)
 			? throw std::logic_error("type of argument does not match element")
 
 		// continue
-		: type_check_impl<format, P...>::g(
-			format.next_literal_index(index)
-		)
+		: type_check_impl<format, P...>::g(index + 1u)
 		;
 	}
 };
@@ -341,11 +341,7 @@ template<
 >
 constexpr bool
 type_check() noexcept {
-	return type_check_impl<format, ArgP...>::g(
-		ElementType::esc == format.elements[0u].type
-			? format.next_literal_index(0u)
-		: 0u
-	);
+	return type_check_impl<format, ArgP...>::g(0u);
 }
 
 } // namespace detail
@@ -10,11 +10,12 @@
 #include <ceformat/config.hpp>
 
 #include <utility>
+#include <cstdint>
 
 namespace ceformat {
 
 // Forward declarations
-enum class ElementType : unsigned;
+enum class ElementType : std::uint8_t;
 enum class ElementFlags : unsigned;
 // get_element_type_name()
 // element_flag_count()
@@ -25,14 +26,19 @@ enum class ElementFlags : unsigned;
 */
 
 enum : std::size_t {
-	/** Maximum number of elements. */
-	ELEMENTS_MAX = 16u,
+	/** Maximum number of elements (see CEFORMAT_CONFIG_ELEMENTS_MAX). */
+	ELEMENTS_MAX = CEFORMAT_CONFIG_ELEMENTS_MAX,
 	/** Last element index. */
 	ELEMENT_LAST = ELEMENTS_MAX - 1,
 	/** Number of element flags. */
 	ELEMENT_FLAG_COUNT = 4u
 };
 
+static_assert(
+	0u < ELEMENTS_MAX && 0xFFFFu > ELEMENTS_MAX,
+	"CEFORMAT_CONFIG_ELEMENTS_MAX must be in [1, 65534]"
+);
+
 enum : char {
 	/** Element definition character. */
 	ELEMENT_CHAR = '%'
@@ -41,7 +47,7 @@ enum : char {
 /**
 	Element type.
 */
-enum class ElementType : unsigned {
+enum class ElementType : std::uint8_t {
 	end = 0u,	/**< Terminator or invalid. */
 	esc,		/**< Escaped @c ELEMENT_CHAR. */
 	chr,		/**< Character. */
@@ -49,7 +55,7 @@ enum class ElementType : unsigned {
 	uns,		/**< Unsigned integral with decimal base. */
 	hex,		/**< Integral with hexadecimal base. */
 	oct,		/**< Integral with octal base. */
-	flt,		/**< Floating-point. */
+	flt,		/**< Floating-point (%g without precision is shortest round-trip). */
 	boo,		/**< Boolean (boolalpha). */
 	ptr,		/**< Pointer. */
 	str,		/**< String or object. */
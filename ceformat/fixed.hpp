@@ -0,0 +1,416 @@
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+
+@file
+@brief Fixed-capacity output.
+*/
+
+#pragma once
+
+#include <ceformat/config.hpp>
+#include <ceformat/String.hpp>
+#include <ceformat/Format.hpp>
+#include <ceformat/print.hpp>
+#include <ceformat/sink.hpp>
+#include <ceformat/detail/type.hpp>
+#include <ceformat/detail/kernel.hpp>
+
+#include <type_traits>
+#include <utility>
+#include <limits>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace ceformat {
+
+/**
+	@addtogroup print
+	@{
+*/
+
+/** @cond INTERNAL */
+namespace detail {
+
+template<
+	class T,
+	class = void
+>
+struct output_bound {
+	static constexpr bool
+	bounded = false;
+
+	static constexpr std::size_t
+	g(
+		Element const&,
+		char const
+	) noexcept {
+		return 0u;
+	}
+};
+
+constexpr std::size_t
+bound_padded(
+	Element const& element,
+	std::size_t const size
+) noexcept {
+	return
+		element.width > size
+		? element.width
+		: size
+	;
+}
+
+// NB: Same bound as the integer kernel buffer: octal digits of the
+// widest value, plus sign or base prefix
+template<class T>
+struct output_bound<
+	T,
+	typename std::enable_if<
+		tte_integral<T>()
+	>::type
+> {
+	static constexpr bool
+	bounded = true;
+
+	static constexpr std::size_t
+	g(
+		Element const& element,
+		char const
+	) noexcept {
+		return bound_padded(
+			element,
+			tte_character<T>()
+			? 1u
+			: (CHAR_BIT * sizeof(rm_cref_t<T>) + 2u) / 3u + 2u
+		);
+	}
+};
+
+// Sign, integral digits of the largest value, point and fraction for
+// %f; sign, significant digits, point, and a 4-digit exponent or up
+// to 5 leading zeros otherwise
+template<class T>
+struct output_bound<
+	T,
+	typename std::enable_if<
+		tte_floating_point<T>()
+	>::type
+> {
+	using V = rm_cref_t<T>;
+
+	static constexpr bool
+	bounded = true;
+
+	static constexpr std::size_t
+	digits(
+		Element const& element,
+		char const spec
+	) noexcept {
+		return
+			float_shortest(element, spec)
+			? static_cast<std::size_t>(
+				std::numeric_limits<float_promote_t<V>>::max_digits10
+			)
+		: -1 == element.precision
+			? 7u
+		: static_cast<std::size_t>(element.precision) + 1u
+		;
+	}
+
+	static constexpr std::size_t
+	g(
+		Element const& element,
+		char const spec
+	) noexcept {
+		return bound_padded(
+			element,
+			'e' == spec || 'g' == spec
+			? digits(element, spec) + 8u
+			: static_cast<std::size_t>(std::numeric_limits<V>::max_exponent10)
+				+ 2u + digits(element, spec)
+		);
+	}
+};
+
+template<class T>
+struct output_bound<
+	T,
+	typename std::enable_if<
+		tte_boolean<T>()
+	>::type
+> {
+	static constexpr bool
+	bounded = true;
+
+	static constexpr std::size_t
+	g(
+		Element const& element,
+		char const
+	) noexcept {
+		return bound_padded(element, 5u);
+	}
+};
+
+template<class T>
+struct output_bound<
+	T,
+	typename std::enable_if<
+		tte_pointer<T>()
+	>::type
+> {
+	static constexpr bool
+	bounded = true;
+
+	static constexpr std::size_t
+	g(
+		Element const& element,
+		char const
+	) noexcept {
+		return bound_padded(element, 2u * sizeof(std::uintptr_t) + 2u);
+	}
+};
+
+// NB: Character arrays are bounded by their extent, less the null
+// terminator; other strings and objects are unbounded
+template<class T>
+struct output_bound<
+	T,
+	typename std::enable_if<
+		tte_string_charwise<T>() &&
+		std::is_array<rm_ref_t<T>>::value
+	>::type
+> {
+	static constexpr bool
+	bounded = true;
+
+	static constexpr std::size_t
+	g(
+		Element const& element,
+		char const
+	) noexcept {
+		return bound_padded(
+			element,
+			0u != std::extent<rm_ref_t<T>>::value
+			? std::extent<rm_ref_t<T>>::value - 1u
+			: 0u
+		);
+	}
+};
+
+template<
+	Format const&,
+	class...
+>
+struct output_bound_impl;
+
+template<
+	Format const& format
+>
+struct output_bound_impl<format> {
+	static constexpr bool
+	bounded = true;
+
+	static constexpr std::size_t
+	g(
+		std::size_t const index
+	) noexcept {
+		return format.segments[index].size;
+	}
+};
+
+template<
+	Format const& format,
+	class I,
+	class... P
+>
+struct output_bound_impl<format, I, P...> {
+	static constexpr bool
+	bounded
+		= output_bound<I>::bounded
+		&& output_bound_impl<format, P...>::bounded
+	;
+
+	static constexpr std::size_t
+	g(
+		std::size_t const index
+	) noexcept {
+		return
+			format.segments[index].size
+			+ output_bound<I>::g(
+				format.elements[format.segments[index].element],
+				format.string[
+					format.elements[format.segments[index].element].end - 1u
+				]
+			)
+			+ output_bound_impl<format, P...>::g(index + 1u)
+		;
+	}
+};
+
+} // namespace detail
+/** @endcond */ // INTERNAL
+
+/**
+	Get upper bound of output size.
+
+	@remarks Bounded arguments are integers, characters, booleans,
+	pointers, floating-point values and character arrays (bounded by
+	their extent). Other strings and objects are unbounded.
+
+	@note Floating-point bounds hold the largest finite value, so
+	@c %%f of a @c long @c double is bounded by several thousand
+	characters.
+
+	@returns Largest number of characters write() outputs for
+	arguments of types @a ArgP.
+	@tparam format %Format.
+	@tparam ...ArgP Argument types.
+*/
+template<
+	Format const& format,
+	class... ArgP
+>
+constexpr std::size_t
+max_output_size() noexcept {
+	static_assert(
+		sizeof...(ArgP) == format.literal_count,
+		"arguments do not match format"
+	);
+	static_assert(
+		detail::output_bound_impl<format, ArgP...>::bounded,
+		"output of argument type is unbounded"
+	);
+	return detail::output_bound_impl<format, ArgP...>::g(0u);
+}
+
+/**
+	Fixed-capacity string.
+
+	@remarks This is trivially copyable and does not allocate, so it
+	can be passed by value (e.g., between threads).
+
+	@tparam N Capacity, not counting the null terminator.
+*/
+template<std::size_t N>
+class FixedString final {
+private:
+	std::size_t m_size;
+	char m_data[N + 1u];
+
+public:
+	/** Capacity. */
+	static constexpr std::size_t const
+	capacity = N;
+
+	/** Construct empty string. */
+	FixedString() noexcept
+		: m_size(0u)
+	{
+		this->m_data[0u] = '\0';
+	}
+
+	/** Get data. */
+	char*
+	data() noexcept {
+		return this->m_data;
+	}
+
+	/** Get data. */
+	char const*
+	data() const noexcept {
+		return this->m_data;
+	}
+
+	/** Get null-terminated data. */
+	char const*
+	c_str() const noexcept {
+		return this->m_data;
+	}
+
+	/** Get size. */
+	std::size_t
+	size() const noexcept {
+		return this->m_size;
+	}
+
+	/** Check if empty. */
+	bool
+	empty() const noexcept {
+		return 0u == this->m_size;
+	}
+
+	/**
+		Set size.
+
+		@param size New size; at most @c capacity.
+	*/
+	void
+	resize(
+		std::size_t const size
+	) noexcept {
+		assert(N >= size);
+		this->m_size = size;
+		this->m_data[size] = '\0';
+	}
+
+	/** Get view of string. */
+	StringView
+	view() const noexcept {
+		return StringView{this->m_data, this->m_size};
+	}
+};
+
+template<std::size_t N>
+constexpr std::size_t const
+FixedString<N>::capacity;
+
+/**
+	Output fixed-capacity string to stream.
+*/
+template<std::size_t N>
+inline std::ostream&
+operator<<(
+	std::ostream& stream,
+	FixedString<N> const& str
+) {
+	return stream.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+/**
+	Print format to fixed-capacity string.
+
+	@remarks Output is the same as format_to(), rendered in place to
+	a string of capacity max_output_size(), so it is never truncated
+	and the heap is not used.
+
+	@returns String.
+	@tparam format %Format.
+	@tparam ...ArgP Argument pack; all types must be bounded (see
+	max_output_size()).
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class... ArgP
+>
+inline FixedString<max_output_size<format, ArgP...>()>
+print_fixed(
+	ArgP&&... args
+) {
+	check_args<format, ArgP...>();
+	FixedString<max_output_size<format, ArgP...>()> str{};
+	BufferSink sink{str.data(), str.data() + str.capacity, 0u};
+	write_impl<format, 0u>(
+		sink,
+		std::forward<ArgP>(args)...
+	);
+	str.resize(static_cast<std::size_t>(sink.pos - str.data()));
+	return str;
+}
+
+/** @} */ // end of doc-group print
+
+} // namespace ceformat
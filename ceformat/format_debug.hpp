@@ -17,37 +17,55 @@
 	@{
 */
 
-/**
-	Debug Element output operator.
-
-	@returns @a stream.
-	@param stream Output stream.
-	@param e %Element.
-*/
-std::ostream&
-operator<<(
+/** @cond INTERNAL */
+namespace ceformat {
+namespace {
+inline void
+write_element_debug(
 	std::ostream& stream,
-	ceformat::Element const& e
+	ceformat::Element const& e,
+	char const* const string
 ) {
 	stream
 		<< "{idx = " << e.idx
 		<< ", beg = " << e.beg
 		<< ", end = " << e.end
 		<< ", width = " << e.width
-		<< ", precision = " << e.precision
-		<< ", flags = " << e.flags
+		<< ", precision = " << static_cast<signed>(e.precision)
+		<< ", flags = " << static_cast<unsigned>(e.flags)
 		<< ", type = " << ceformat::get_element_type_name(e.type)
 	;
-	if (ceformat::ElementType::end != e.type) {
+	if (nullptr != string && ceformat::ElementType::end != e.type) {
 		stream << ", blob = \"";
 		stream.write(
-			e.fmt.string + e.beg,
+			string + e.beg,
 			static_cast<std::streamsize>(e.end - e.beg)
 		);
 		stream << "\"}";
 	} else {
 		stream << '}';
 	}
+}
+} // anonymous namespace
+} // namespace ceformat
+/** @endcond */
+
+/**
+	Debug Element output operator.
+
+	@note Elements don't reference their format, so the element text
+	is only written by the %Format output operator.
+
+	@returns @a stream.
+	@param stream Output stream.
+	@param e %Element.
+*/
+std::ostream&
+operator<<(
+	std::ostream& stream,
+	ceformat::Element const& e
+) {
+	ceformat::write_element_debug(stream, e, nullptr);
 	return stream;
 }
 
@@ -69,6 +87,7 @@ operator<<(
 		<< "  size = " << f.size << ",\n"
 		<< "  element_count = " << f.element_count << ",\n"
 		<< "  literal_count = " << f.literal_count << ",\n"
+		<< "  escape_count = " << f.escape_count << ",\n"
 		<< "  elements: {"
 	;
 	for (
@@ -76,7 +95,26 @@ operator<<(
 		(ceformat::ELEMENTS_MAX + 1u) > index;
 		++index
 	) {
-		stream << "\n    " << f.elements[index];
+		stream << "\n    ";
+		ceformat::write_element_debug(stream, f.elements[index], f.string);
+	}
+	stream << "\n  },\n  segments: {";
+	for (
+		std::size_t index = 0u;
+		f.literal_count >= index;
+		++index
+	) {
+		ceformat::Segment const& s = f.segments[index];
+		stream
+			<< "\n    {beg = " << s.beg
+			<< ", size = " << s.size
+			<< ", element = " << s.element
+			<< ", blob = \""
+		;
+		for (std::size_t pos = s.beg; s.beg + s.size > pos; ++pos) {
+			stream << f.literal_char(pos);
+		}
+		stream << "\"}";
 	}
 	stream << "\n  }\n}";
 	return stream;
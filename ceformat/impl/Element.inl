@@ -8,385 +8,344 @@
 
 constexpr
 Element::Element(
-	Format const& fmt,
 	std::size_t const index,
+	std::size_t const size,
 	Element::ctor_invalid const
 ) noexcept
-	: fmt(fmt)
-	, idx(index)
-	, beg(fmt.size)
+	: idx(static_cast<std::uint16_t>(index))
+	, beg(static_cast<std::uint16_t>(size))
+	, end(static_cast<std::uint16_t>(size))
+	, width(0u)
 	, type(ElementType::end)
 	, flags(0u)
-	, width(0u)
 	, precision(-1)
-	, end(fmt.size)
 	, valid_(false)
 {}
 
 constexpr
 Element::Element(
-	Format const& fmt,
+	Element::Parser const& parser
+)
+	: idx(static_cast<std::uint16_t>(parser.idx))
+	, beg(static_cast<std::uint16_t>(parser.beg))
+	, end(static_cast<std::uint16_t>(parser.end))
+	, width(
+		UINT16_MAX < parser.width
+		? throw std::logic_error("element width too large")
+		: static_cast<std::uint16_t>(parser.width)
+	)
+	, type(parser.type)
+	, flags(static_cast<std::uint8_t>(parser.flags))
+	, precision(
+		INT8_MAX < parser.precision
+		? throw std::logic_error("element precision too large")
+		: static_cast<std::int8_t>(parser.precision)
+	)
+	, valid_(parser.valid_)
+{}
+
+// class Element::Parser implementation
+
+constexpr
+Element::Parser::Parser(
+	char const* const string,
+	std::size_t const size,
+	std::size_t const limit,
 	std::size_t const index,
 	std::size_t const pos
-) noexcept
-	: fmt(fmt)
+)
+	: string(string)
+	, size(size)
+	, limit(limit)
 	, idx(index)
 	, beg(cons_beg(pos))
-	, type(cons_type(this->beg + 1u))
-	, flags(cons_flags(this->beg + 1u, false, NumeralSegment::none, false, 0u))
-	, width(cons_width(this->beg + 1u, false, 0u))
-	, precision(cons_precision(this->beg + 1u, false, -1))
-	, end(cons_end())
+	, scan(cons_scan(this->beg + 1u, Scan{
+		this->beg,
+		ElementType::end,
+		FlagsState{false, NumeralSegment::none, false, 0u, Error::none},
+		WidthState{false, false, 0u, Error::none},
+		PrecisionState{false, -1, Error::none}
+	}))
+	, type(this->scan.type)
+	// NB: Errors are raised in field order
+	, flags(error_check(this->scan.f.error) ? this->scan.f.flags : 0u)
+	, width(error_check(this->scan.w.error) ? this->scan.w.width : 0u)
+	, precision(error_check(this->scan.p.error) ? this->scan.p.precision : -1)
+	, end(
+		ElementType::end == this->type
+		? this->size
+		: this->scan.pos + 1u
+	)
 	, valid_(valid_check())
 {}
 
 // beg
 
 constexpr std::size_t
-Element::cons_beg(
+Element::Parser::cons_beg(
 	std::size_t const pos
 ) const noexcept {
-	return false ? 0u
-	// No element found; this is an ElementType::end
-	: pos >= this->fmt.size
-		? this->fmt.size
-
-	// Found element
-	: ELEMENT_CHAR == this->fmt.string[pos]
-		? pos
-
-	// Next
-	: cons_beg(pos + 1u)
-	;
+	// NB: If no element is found, this is an ElementType::end
+	return utility::find_char(this->string, ELEMENT_CHAR, pos, this->size);
 }
 
-// type
+// scan
 
-constexpr ElementType
-Element::cons_type_inner(
-	Particle const& particle,
-	std::size_t const next
-) const noexcept {
-	return false ? ElementType::end
-	: ParticleKind::invalid == particle.kind
-		? throw std::logic_error("format string overflow; malformed element")
-
-	// Take type
-	: ParticleKind::type == particle.kind
-		? particle.type
-
-	// Continue otherwise
-	: cons_type(next)
-	;
-}
-
-constexpr ElementType
-Element::cons_type(
-	std::size_t const pos
-) const noexcept {
-	return false ? ElementType::end
-	// If no ELEMENT_CHAR was found in cons_beg()
-	: this->beg == this->fmt.size
-		? ElementType::end
-
-	: pos >= this->fmt.size
-		? throw std::logic_error("format string overflow; malformed element")
-
-	// Process next particle
-	: cons_type_inner(
-		particle_classify(this->fmt.string[pos]),
-		pos + 1u
-	)
-	;
-}
-
-// flags
-
-constexpr unsigned
-Element::cons_flags_inner(
+constexpr Element::Parser::FlagsState
+Element::Parser::next_flags(
+	FlagsState const& s,
 	char const value,
-	Particle const& particle,
-	std::size_t const next,
-	bool const zero_padded,
-	NumeralSegment const segment,
-	bool const precision_prelude,
-	unsigned const c_flags
-) const noexcept {
-	return false ? 0u
-	: ParticleKind::invalid == particle.kind
-		? throw std::logic_error("format string overflow; malformed element")
+	Particle const& particle
+) noexcept {
+	return false ? s
+	: Error::none != s.error
+		? s
 
-	: precision_prelude
+	: s.precision_prelude
 		? ParticleKind::numeral != particle.kind
-			? throw std::logic_error("expected numeral after precision marker")
+			? FlagsState{
+				s.zero_padded, s.segment, s.precision_prelude, s.flags,
+				Error::expected_precision_numeral
+			}
 
-		: cons_flags(
-			next,
-			zero_padded,
+		: FlagsState{
+			s.zero_padded,
 			NumeralSegment::precision,
 			false,
-			c_flags | particle.flag
-		)
+			s.flags | particle.flag,
+			Error::none
+		}
 
 	// Multiple leading zeros is invalid
 	: ParticleKind::numeral == particle.kind
-	&& NumeralSegment::none == segment && '0' == value && zero_padded
-		? throw std::logic_error("only one leading zero in width is permitted")
+	&& NumeralSegment::none == s.segment && '0' == value && s.zero_padded
+		? FlagsState{
+			s.zero_padded, s.segment, s.precision_prelude, s.flags,
+			Error::leading_zero
+		}
 
 	: ParticleKind::precision == particle.kind
-		? cons_flags(
-			next,
-			zero_padded,
-			segment,
+		? FlagsState{
+			s.zero_padded,
+			s.segment,
 			true,
-			c_flags | particle.flag
-		)
+			s.flags | particle.flag,
+			Error::none
+		}
 
 	: ParticleKind::numeral == particle.kind
-		? '0' == value && NumeralSegment::none == segment
-			? zero_padded
-				? throw std::logic_error("zero-pad already specified")
-			: cons_flags(
-				next,
+		? '0' == value && NumeralSegment::none == s.segment
+			? s.zero_padded
+				? FlagsState{
+					s.zero_padded, s.segment, s.precision_prelude, s.flags,
+					Error::zero_pad_repeated
+				}
+			: FlagsState{
 				true,
-				segment,
+				s.segment,
 				false,
-				c_flags | static_cast<unsigned>(ElementFlags::zero_padded)
-			)
-		: cons_flags(
-			next,
-			zero_padded,
-			NumeralSegment::none == segment
+				s.flags | static_cast<unsigned>(ElementFlags::zero_padded),
+				Error::none
+			}
+		: FlagsState{
+			s.zero_padded,
+			NumeralSegment::none == s.segment
 				? NumeralSegment::width
-				: segment
+				: s.segment
 			,
 			false,
-			c_flags
-		)
+			s.flags,
+			Error::none
+		}
 
 	: ParticleKind::flag == particle.kind
 		// Flag after width/precision is invalid
-		? NumeralSegment::none != segment
-			? throw std::logic_error("flags must occur before width and precision")
-
-		// Include flag and continue
-		: cons_flags(
-			next,
-			zero_padded,
-			segment,
+		? NumeralSegment::none != s.segment
+			? FlagsState{
+				s.zero_padded, s.segment, s.precision_prelude, s.flags,
+				Error::flag_after_numeral
+			}
+
+		// Include flag
+		: FlagsState{
+			s.zero_padded,
+			s.segment,
 			false,
-			c_flags | particle.flag
-		)
-
-	// Terminate at ParticleKind::type
-	: c_flags
-	;
-}
-
-constexpr unsigned
-Element::cons_flags(
-	std::size_t const pos,
-	bool const zero_padded,
-	NumeralSegment const segment,
-	bool const precision_prelude,
-	unsigned const c_flags
-) const noexcept {
-	return false ? 0u
-	// No flags
-	: ElementType::end == this->type
-		? 0u
-
-	: pos >= this->fmt.size
-		? throw std::logic_error("format string overflow; malformed element")
+			s.flags | particle.flag,
+			Error::none
+		}
 
-	// Process next particle
-	: cons_flags_inner(
-		this->fmt.string[pos],
-		particle_classify(this->fmt.string[pos]),
-		pos + 1u,
-		zero_padded,
-		segment,
-		precision_prelude,
-		c_flags
-	)
+	: s
 	;
 }
 
-// width
-
-constexpr std::size_t
-Element::cons_width_inner(
+constexpr Element::Parser::WidthState
+Element::Parser::next_width(
+	WidthState const& s,
 	char const value,
-	Particle const& particle,
-	std::size_t const next,
-	bool const in_width,
-	unsigned const width_accum
-) const noexcept {
-	return false ? 0u
-	: ParticleKind::invalid == particle.kind
-		? throw std::logic_error("format string overflow; malformed element")
+	Particle const& particle
+) noexcept {
+	return false ? s
+	: Error::none != s.error || s.done
+		? s
 
 	: ParticleKind::flag == particle.kind
-	&& in_width
-		? throw std::logic_error("width must come after flags")
+	&& s.in_width
+		? WidthState{s.done, s.in_width, s.width, Error::width_after_flag}
 
-	// Include digit and continue
+	// Include digit; stops past the largest width (which is then
+	// reported by Element) so that long runtime input can't overflow
 	: ParticleKind::numeral == particle.kind
-	&& (in_width || '0' != value)
-		? cons_width(
-			next,
+	&& (s.in_width || '0' != value)
+		? WidthState{
+			false,
 			true,
-			(width_accum * 10u)
-			+ static_cast<unsigned>(value - '0')
-		)
+			UINT16_MAX < s.width
+				? s.width
+				: (s.width * 10u) + static_cast<unsigned>(value - '0'),
+			Error::none
+		}
 
 	// Terminate at precision or type
 	: ParticleKind::precision == particle.kind
 	|| ParticleKind::type == particle.kind
-		? width_accum
-
-	// Continue (ParticleKind::flag)
-	: cons_width(next, in_width, width_accum)
-	;
-}
-
-constexpr std::size_t
-Element::cons_width(
-	std::size_t pos,
-	bool const in_width,
-	unsigned const width_accum
-) const noexcept {
-	return false ? 0u
-	// No flags
-	: ElementType::end == this->type
-		? 0u
-
-	: pos >= this->fmt.size
-		? throw std::logic_error("format string overflow; malformed element")
+		? WidthState{true, s.in_width, s.width, Error::none}
 
-	// Process next particle
-	: cons_width_inner(
-		this->fmt.string[pos],
-		particle_classify(this->fmt.string[pos]),
-		pos + 1u,
-		in_width,
-		width_accum
-	)
+	: s
 	;
 }
 
-// precision
-
-constexpr signed
-Element::cons_precision_inner(
+constexpr Element::Parser::PrecisionState
+Element::Parser::next_precision(
+	PrecisionState const& s,
 	char const value,
-	Particle const& particle,
-	std::size_t const next,
-	bool const in_precision,
-	signed const precision_accum
-) const noexcept {
-	return false ? -1
-	: ParticleKind::invalid == particle.kind
-		? throw std::logic_error("format string overflow; malformed element")
+	Particle const& particle
+) noexcept {
+	return false ? s
+	: Error::none != s.error
+		? s
 
 	: ParticleKind::flag == particle.kind
-	&& in_precision
-		? throw std::logic_error("precision must come after flags")
+	&& s.in_precision
+		? PrecisionState{s.in_precision, s.precision, Error::precision_after_flag}
 
 	: ParticleKind::precision == particle.kind
-	&& in_precision
-		? throw std::logic_error("precision specified more than once")
+	&& s.in_precision
+		? PrecisionState{s.in_precision, s.precision, Error::precision_repeated}
 
 	: ParticleKind::precision == particle.kind
-	&& !in_precision
-		? cons_precision(
-			next,
-			true,
-			0
-		)
+		? PrecisionState{true, 0, Error::none}
 
-	// Include digit and continue
+	// Include digit; stops past the largest precision (as with width)
 	: ParticleKind::numeral == particle.kind
-	&& in_precision
-		? cons_precision(
-			next,
+	&& s.in_precision
+		? PrecisionState{
 			true,
-			(precision_accum * 10)
-			+ static_cast<unsigned>(value - '0')
-		)
+			INT8_MAX < s.precision
+				? s.precision
+				: (s.precision * 10) + static_cast<signed>(value - '0'),
+			Error::none
+		}
 
-	// Terminate at ParticleKind::type
-	: ParticleKind::type == particle.kind
-		? precision_accum
+	: s
+	;
+}
 
-	// Continue (ParticleKind::numeral, ParticleKind::flag)
-	: cons_precision(next, in_precision, precision_accum)
+constexpr Element::Parser::Scan
+Element::Parser::cons_scan_inner(
+	std::size_t const pos,
+	char const value,
+	Particle const& particle,
+	Scan const& s
+) const {
+	return false ? s
+	: ParticleKind::invalid == particle.kind
+		? throw std::logic_error("format string overflow; malformed element")
+
+	// Terminate at type (which still ends a pending precision marker)
+	: ParticleKind::type == particle.kind
+		? Scan{pos, particle.type, next_flags(s.f, value, particle), s.w, s.p}
+
+	// Advance each field
+	: cons_scan(pos + 1u, Scan{
+		pos,
+		s.type,
+		next_flags(s.f, value, particle),
+		next_width(s.w, value, particle),
+		next_precision(s.p, value, particle)
+	})
 	;
 }
 
-constexpr signed
-Element::cons_precision(
-	std::size_t pos,
-	bool const in_precision,
-	signed const precision_accum
-) const noexcept {
-	return false ? -1
-	// No flags
-	: ElementType::end == this->type
-		? -1
+// NB: Each character is classified once, and all fields are advanced
+// together.
+constexpr Element::Parser::Scan
+Element::Parser::cons_scan(
+	std::size_t const pos,
+	Scan const& s
+) const {
+	return false ? s
+	// If no ELEMENT_CHAR was found in cons_beg()
+	: this->beg == this->size
+		? s
 
-	: pos >= this->fmt.size
+	: pos >= this->size
 		? throw std::logic_error("format string overflow; malformed element")
 
-	// Process next particle
-	: cons_precision_inner(
-		this->fmt.string[pos],
-		particle_classify(this->fmt.string[pos]),
-		pos + 1u,
-		in_precision,
-		precision_accum
+	: cons_scan_inner(
+		pos,
+		this->string[pos],
+		particle_classify(this->string[pos]),
+		s
 	)
 	;
 }
 
-// end
+constexpr bool
+Element::Parser::error_check(
+	Error const error
+) {
+	return false ? false
+	: Error::expected_precision_numeral == error
+		? throw std::logic_error("expected numeral after precision marker")
 
-constexpr std::size_t
-Element::cons_end() const noexcept {
-	return
-	// Force to end of format string
-	ElementType::end == this->type
-		? this->fmt.size
-
-	// Calculate actual range of element
-	: this->beg
-		+ 1u // ELEMENT_CHAR
-		+ element_flag_count(this->flags)
-		+ (0u < this->width
-			? utility::digit_count(this->width)
-		: 0u)
-		+ (-1 < this->precision
-			? 1 + utility::digit_count(static_cast<unsigned>(this->precision))
-		: 0)
-		+ 1u // Type character
+	: Error::leading_zero == error
+		? throw std::logic_error("only one leading zero in width is permitted")
+
+	: Error::zero_pad_repeated == error
+		? throw std::logic_error("zero-pad already specified")
+
+	: Error::flag_after_numeral == error
+		? throw std::logic_error("flags must occur before width and precision")
+
+	: Error::width_after_flag == error
+		? throw std::logic_error("width must come after flags")
+
+	: Error::precision_after_flag == error
+		? throw std::logic_error("precision must come after flags")
+
+	: Error::precision_repeated == error
+		? throw std::logic_error("precision specified more than once")
+
+	: true
 	;
 }
 
 // valid_
 
 constexpr bool
-Element::flag_check() const noexcept {
+Element::Parser::flag_check() const noexcept {
 	return
 	0u == (this->flags & ~s_flags_permitted[static_cast<unsigned>(this->type)]);
 }
 
 constexpr bool
-Element::valid_check() const noexcept {
+Element::Parser::valid_check() const {
 	return false ? false
-	: ELEMENTS_MAX == this->idx && ElementType::end != this->type
+	: this->limit == this->idx && ElementType::end != this->type
 		? throw std::logic_error("number of elements exceeds maximum")
 
-	: fmt.size < this->end
+	: this->size < this->end
 		? throw std::logic_error("internal: element size improperly calculated")
 
 	: !flag_check()
@@ -0,0 +1,260 @@
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+
+@file
+@brief Scatter-gather output.
+*/
+
+#pragma once
+
+#include <ceformat/config.hpp>
+#include <ceformat/Format.hpp>
+#include <ceformat/print.hpp>
+#include <ceformat/sink.hpp>
+
+#if CEFORMAT_CONFIG_IOVEC
+
+#include <utility>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace ceformat {
+
+/**
+	@addtogroup print
+	@{
+*/
+
+/**
+	Sink gathering output for @c writev().
+
+	Literal text and string arguments are referenced in place; only
+	other output (e.g., numbers and padding) is copied, into a scratch
+	buffer. Output is written to the file descriptor by flush(), or
+	when the iovec array or the scratch buffer is full.
+
+	@warning Referenced strings must be valid until output is flushed.
+	To batch records, their string arguments must outlive the batch;
+	write_fd() flushes after a single record.
+
+	@note Writes are retried after partial writes and @c EINTR. After
+	an error, output is discarded until the sink is destroyed.
+
+	@tparam iov_capacity Size of the iovec array; at most @c IOV_MAX.
+	@tparam scratch_capacity Size of the scratch buffer.
+*/
+template<
+	std::size_t iov_capacity = 64u,
+	std::size_t scratch_capacity = 512u
+>
+class IovecSink final {
+	static_assert(
+		1u < iov_capacity && 1024u >= iov_capacity,
+		"iov_capacity must be in [2, 1024]"
+	);
+	static_assert(
+		0u != scratch_capacity,
+		"scratch_capacity must be non-zero"
+	);
+
+private:
+	int const m_fd;
+	int m_error;
+	std::size_t m_count;
+	std::size_t m_used;
+	struct iovec m_iov[iov_capacity];
+	char m_scratch[scratch_capacity];
+
+	void
+	push(
+		char const* const data,
+		std::size_t const size
+	) noexcept {
+		if (0u != this->m_count) {
+			struct iovec& last = this->m_iov[this->m_count - 1u];
+			if (static_cast<char const*>(last.iov_base) + last.iov_len == data) {
+				last.iov_len += size;
+				return;
+			}
+		}
+		this->m_iov[this->m_count].iov_base = const_cast<char*>(data);
+		this->m_iov[this->m_count].iov_len = size;
+		++this->m_count;
+	}
+
+	// Make room for size bytes of scratch and one iovec
+	void
+	prepare(
+		std::size_t const size
+	) noexcept {
+		if (
+			iov_capacity == this->m_count ||
+			scratch_capacity - this->m_used < size
+		) {
+			flush();
+		}
+	}
+
+public:
+	IovecSink(IovecSink const&) = delete;
+	IovecSink& operator=(IovecSink const&) = delete;
+
+	/**
+		Construct with file descriptor.
+
+		@param fd File descriptor to write to.
+	*/
+	explicit
+	IovecSink(
+		int const fd
+	) noexcept
+		: m_fd(fd)
+		, m_error(0)
+		, m_count(0u)
+		, m_used(0u)
+	{}
+
+	/** Flush and destruct. */
+	~IovecSink() {
+		flush();
+	}
+
+	/**
+		Get error.
+
+		@returns @c errno of the failed write, or 0.
+	*/
+	int
+	error() const noexcept {
+		return this->m_error;
+	}
+
+	/** Reference characters. */
+	void
+	append_ref(
+		char const* const data,
+		std::size_t const size
+	) noexcept {
+		if (0u == size) {
+			return;
+		} else if (iov_capacity == this->m_count) {
+			flush();
+		}
+		push(data, size);
+	}
+
+	/** Append characters. */
+	void
+	append(
+		char const* const data,
+		std::size_t const size
+	) noexcept {
+		if (0u == size) {
+			return;
+		} else if (scratch_capacity < size) {
+			// Written before data goes away
+			append_ref(data, size);
+			flush();
+			return;
+		}
+		prepare(size);
+		char* const pos = this->m_scratch + this->m_used;
+		std::memcpy(pos, data, size);
+		this->m_used += size;
+		push(pos, size);
+	}
+
+	/** Append @a count copies of @a value. */
+	void
+	append(
+		char const value,
+		std::size_t count
+	) noexcept {
+		while (0u < count) {
+			std::size_t const chunk
+				= count < scratch_capacity
+				? count
+				: scratch_capacity
+			;
+			prepare(chunk);
+			char* const pos = this->m_scratch + this->m_used;
+			std::memset(pos, value, chunk);
+			this->m_used += chunk;
+			push(pos, chunk);
+			count -= chunk;
+		}
+	}
+
+	/**
+		Write output.
+
+		@returns @c true if all output has been written.
+	*/
+	bool
+	flush() noexcept {
+		struct iovec* iov = this->m_iov;
+		std::size_t count = this->m_count;
+		while (0u < count && 0 == this->m_error) {
+			ssize_t const written = ::writev(
+				this->m_fd, iov, static_cast<int>(count)
+			);
+			if (0 > written) {
+				if (EINTR != errno) {
+					this->m_error = errno;
+				}
+				continue;
+			}
+			std::size_t left = static_cast<std::size_t>(written);
+			while (0u < count && iov->iov_len <= left) {
+				left -= iov->iov_len;
+				++iov;
+				--count;
+			}
+			if (0u < count) {
+				iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+				iov->iov_len -= left;
+			}
+		}
+		this->m_count = 0u;
+		this->m_used = 0u;
+		return 0 == this->m_error;
+	}
+};
+
+/**
+	Write format to file descriptor with a single @c writev().
+
+	@remarks Literal text and string arguments are not copied (see
+	IovecSink). Records that do not fit an IovecSink take more than
+	one @c writev().
+
+	@returns @c true if all output was written; otherwise @c errno
+	describes the error.
+	@tparam format %Format.
+	@tparam ...ArgP Argument pack.
+	@param fd File descriptor to write to.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class... ArgP
+>
+inline bool
+write_fd(
+	int const fd,
+	ArgP&&... args
+) {
+	IovecSink<> sink{fd};
+	write<format>(sink, std::forward<ArgP>(args)...);
+	return sink.flush();
+}
+
+/** @} */ // end of doc-group print
+
+} // namespace ceformat
+
+#endif // CEFORMAT_CONFIG_IOVEC
@@ -11,11 +11,21 @@
 #include <ceformat/String.hpp>
 #include <ceformat/element_defs.hpp>
 #include <ceformat/Format.hpp>
+#include <ceformat/sink.hpp>
 #include <ceformat/detail/type.hpp>
+#include <ceformat/detail/sequence.hpp>
+#include <ceformat/detail/literal.hpp>
+#include <ceformat/detail/kernel.hpp>
 
 #include <type_traits>
-#include <functional>
+#include <tuple>
+#include <string>
 #include <iostream>
+#include <locale>
+
+#if CEFORMAT_CONFIG_PMR
+	#include <memory_resource>
+#endif
 
 namespace ceformat {
 
@@ -42,171 +52,651 @@ type_flag_table[]{
 	ios::oct,		// oct
 	flag_none,		// flt; handled based on format symbol
 	ios::boolalpha,	// boo
-	ios::hex,		// ptr
-	flag_none	// str
+	flag_none,	// ptr; std::num_put forces hex and showbase
+	ios::dec	// str; objects start from the default state
 },
-stream_flag_mask
-	= ios::showpos
-	| ios::showbase
-	| ios::showpoint
-	| ios::basefield
-	| ios::floatfield
-	| ios::adjustfield
-	| ios::boolalpha
-;
+// Flags which affect output for each type (except adjustfield, which
+// only matters when the element has a width)
+type_mask_table[]{
+	flag_none,	// end
+	flag_none,	// esc
+	flag_none,	// chr
+	ios::basefield | ios::showpos,		// dec
+	ios::basefield,						// uns
+	ios::basefield | ios::showbase,		// hex
+	ios::basefield | ios::showbase,		// oct
+	ios::floatfield | ios::showpoint | ios::showpos,	// flt
+	ios::boolalpha,	// boo
+	flag_none,	// ptr
+	ios::basefield | ios::showpos | ios::showbase | ios::showpoint
+	| ios::floatfield | ios::boolalpha | ios::uppercase	// str
+};
+
+// Flags which are restored after each value, since the types which do
+// not reset them take them from the stream
+static constexpr ios::fmtflags const
+restore_mask = ios::uppercase;
 
 static_assert(
 	static_cast<unsigned>(ElementType::NUM) ==
-	std::extent<decltype(type_flag_table)>::value,
-	"type_flag_table needs to be updated to match ElementType"
+	std::extent<decltype(type_flag_table)>::value &&
+	static_cast<unsigned>(ElementType::NUM) ==
+	std::extent<decltype(type_mask_table)>::value,
+	"type_flag_table and type_mask_table need to be updated to match ElementType"
 );
 
-template<
-	Format const& format,
-	class Arg
->
-inline void
-write_element(
-	std::ostream& stream,
-	Element const& element,
-	Arg&& arg
-) {
-	struct {
-		ios::fmtflags flags;
-		std::streamsize width;
-		std::streamsize precision;
-		char fill;
-	} const orig{
-		stream.flags(),
-		stream.width(),
-		stream.precision(),
-		stream.fill()
-	};
+// Stream formatting state. Unset fields are flag_none (mask), '\0'
+// (fill) and -1 (precision). A precision of -2 refers to the
+// precision the stream had before writing.
+struct StreamState final {
+	ios::fmtflags flags;
+	ios::fmtflags mask;
+	char fill;
+	std::streamsize precision;
+};
 
-	ios::fmtflags stream_flags
-		= type_flag_table[static_cast<unsigned>(element.type)]
+constexpr StreamState const
+s_state_none{flag_none, flag_none, '\0', -2};
 
-		// element flags
-		| (element.has_flag(ElementFlags::alternative)
-			? ios::showbase | ios::showpoint
+constexpr ios::fmtflags
+element_state_mask(
+	Element const& element
+) noexcept {
+	return
+		type_mask_table[static_cast<unsigned>(element.type)]
+		| (0u != element.width
+			? ios::adjustfield
 			: flag_none
 		)
-		| (element.has_flag(ElementFlags::show_sign)
-			? ios::showpos
+	;
+}
+
+constexpr StreamState
+element_state(
+	Element const& element,
+	char const spec
+) noexcept {
+	return StreamState{
+		element_state_mask(element) & (
+			type_flag_table[static_cast<unsigned>(element.type)]
+			| ('f' == spec && ElementType::flt == element.type
+				? ios::fixed
+			: 'e' == spec && ElementType::flt == element.type
+				? ios::scientific
 			: flag_none
+			)
+
+			// element flags
+			| (element.has_flag(ElementFlags::alternative)
+				? ios::showbase | ios::showpoint
+				: flag_none
+			)
+			| (element.has_flag(ElementFlags::show_sign)
+				? ios::showpos
+				: flag_none
+			)
+			| (element.has_flag(ElementFlags::left_align)
+				? ios::left
+				: ios::internal
+			)
+		),
+		element_state_mask(element),
+		0u != element.width
+			? element.has_flag(ElementFlags::zero_padded)
+				? '0'
+				: ' '
+			: '\0'
+		,
+		ElementType::flt != element.type &&
+		ElementType::str != element.type
+			? -1
+		: -1 == element.precision
+			? -2
+		: static_cast<std::streamsize>(element.precision)
+	};
+}
+
+template<
+	Format const& format
+>
+constexpr StreamState
+value_state(
+	std::size_t const index
+) noexcept {
+	return element_state(
+		format.elements[format.segments[index].element],
+		format.string[format.elements[format.segments[index].element].end - 1u]
+	);
+}
+
+constexpr StreamState
+merge_state(
+	StreamState const known,
+	StreamState const next
+) noexcept {
+	return StreamState{
+		((known.flags & ~next.mask) | (next.flags & next.mask)) & ~restore_mask,
+		(known.mask | next.mask) & ~restore_mask,
+		'\0' != next.fill ? next.fill : known.fill,
+		-1 != next.precision ? next.precision : known.precision
+	};
+}
+
+// State of stream after the values before index are written
+template<
+	Format const& format
+>
+constexpr StreamState
+known_state(
+	std::size_t const index
+) noexcept {
+	return
+		0u == index
+		? s_state_none
+		: merge_state(
+			known_state<format>(index - 1u),
+			value_state<format>(index - 1u)
 		)
-		| (element.has_flag(ElementFlags::left_align)
-			? ios::left
-			: ios::internal
+	;
+}
+
+// Flags that need to be set for next
+constexpr ios::fmtflags
+changed_mask(
+	StreamState const known,
+	StreamState const next
+) noexcept {
+	return next.mask & (~known.mask | (known.flags ^ next.flags));
+}
+
+template<
+	Format const& format
+>
+constexpr bool
+touches_width(
+	std::size_t const index = 0u
+) noexcept {
+	return
+		format.literal_count > index && (
+			0u != format.elements[format.segments[index].element].width ||
+			touches_width<format>(index + 1u)
 		)
 	;
-	stream.fill(
-		element.has_flag(ElementFlags::zero_padded)
-			? '0'
-			: ' '
-	);
+}
+
+template<
+	Format const& format
+>
+constexpr bool
+touches_precision(
+	std::size_t const index = 0u
+) noexcept {
+	return
+		format.literal_count > index && (
+			0 <= value_state<format>(index).precision ||
+			touches_precision<format>(index + 1u)
+		)
+	;
+}
+
+// Stream with the state that a format modifies saved; the state is
+// restored on destruction
+template<
+	Format const& format
+>
+struct StateStream final {
+	static constexpr StreamState const
+	s_final = known_state<format>(format.literal_count);
+
+	std::ostream& stream;
+	ios::fmtflags const flags;
+	std::streamsize const width;
+	std::streamsize const precision;
+	char const fill;
+
+	StateStream(StateStream const&) = delete;
+	StateStream& operator=(StateStream const&) = delete;
+
+	explicit
+	StateStream(
+		std::ostream& stream
+	)
+		: stream(stream)
+		, flags(flag_none != s_final.mask ? stream.flags() : flag_none)
+		, width(touches_width<format>() ? stream.width() : 0)
+		, precision(touches_precision<format>() ? stream.precision() : 0)
+		, fill('\0' != s_final.fill ? stream.fill() : '\0')
+	{}
 
-	switch ((element.fmt.string + element.end)[-1]) {
-	case 'f': stream_flags |= ios::fixed; break;
-	case 'e': stream_flags |= ios::scientific; break;
-	case 'g':
-		if (!element.has_flag(ElementFlags::alternative)) {
-			stream_flags &= ~ios::showpoint;
+	~StateStream() {
+		if (flag_none != s_final.mask) {
+			this->stream.flags(this->flags);
+		}
+		if (touches_width<format>()) {
+			this->stream.width(this->width);
+		}
+		if (touches_precision<format>()) {
+			this->stream.precision(this->precision);
+		}
+		if ('\0' != s_final.fill) {
+			this->stream.fill(this->fill);
 		}
-		break;
 	}
+};
 
-	if (0u != element.width) {
-		stream.width(static_cast<std::streamsize>(element.width));
+template<
+	Format const& format
+>
+constexpr StreamState const
+StateStream<format>::s_final;
+
+// Whether the kernels output the same as the stream would for values
+// that don't read precision, i.e., the stream has no width, no
+// uppercase and the classic locale
+inline bool
+stream_classic(
+	std::ostream const& stream
+) {
+	return
+		0 == stream.width() &&
+		flag_none == (ios::uppercase & stream.flags()) &&
+		std::locale::classic() == stream.getloc()
+	;
+}
+
+// NB: Shortest floating-point values don't depend on precision, so
+// they are rendered by their kernel unless the stream would render
+// them differently.
+template<class T>
+inline typename std::enable_if<
+	detail::tte_floating_point<T>() &&
+	!std::is_same<long double, detail::rm_cref_t<T>>::value,
+	bool
+>::type
+write_shortest(
+	std::ostream& stream,
+	Element const& element,
+	char const spec,
+	T&& value
+) {
+	if (!detail::float_shortest(element, spec) || !stream_classic(stream)) {
+		return false;
 	}
-	if (-1 != element.precision) {
-		stream.precision(static_cast<std::streamsize>(element.precision));
+	char buffer[detail::FLOAT_BUFFER_SIZE];
+	BufferSink sink{buffer, buffer + sizeof(buffer), 0u};
+	detail::write_value(sink, element, spec, value);
+	if (sizeof(buffer) >= sink.size) {
+		stream.write(buffer, static_cast<std::streamsize>(sink.size));
+	} else {
+		String large;
+		StringSink large_sink{large};
+		detail::write_value(large_sink, element, spec, value);
+		stream.write(large.data(), static_cast<std::streamsize>(large.size()));
 	}
+	return true;
+}
 
-	stream.setf(
-		stream_flags,
-		stream_flag_mask
-	);
-	stream <<
+template<class T>
+inline typename std::enable_if<
+	!detail::tte_floating_point<T>() ||
+	std::is_same<long double, detail::rm_cref_t<T>>::value,
+	bool
+>::type
+write_shortest(
+	std::ostream& /*stream*/,
+	Element const& /*element*/,
+	char const /*spec*/,
+	T&& /*value*/
+) noexcept {
+	return false;
+}
+
+// NB: Stream state is only changed where it differs from the state
+// left by the previous value.
+template<
+	Format const& format,
+	std::size_t index,
+	class Arg
+>
+inline void
+write_element(
+	StateStream<format>& out,
+	Arg&& arg
+) {
+	static constexpr StreamState const
+	known = known_state<format>(index),
+	next = value_state<format>(index);
+	static constexpr ios::fmtflags const
+	mask = changed_mask(known, next);
+
+	if (flag_none != mask) {
+		out.stream.setf(next.flags, mask);
+	}
+	if ('\0' != next.fill && known.fill != next.fill) {
+		out.stream.fill(next.fill);
+	}
+	if (-1 != next.precision && known.precision != next.precision) {
+		out.stream.precision(
+			-2 == next.precision
+			? out.precision
+			: next.precision
+		);
+	}
+
+	Element const& element = format.elements[format.segments[index].element];
+	if (write_shortest(
+		out.stream, element, format.string[element.end - 1u], arg
+	)) {
+		return;
+	}
+	if (0u != element.width) {
+		out.stream.width(static_cast<std::streamsize>(element.width));
+	}
+	out.stream <<
 		static_cast<typename detail::type_to_element<Arg>::cast>(
 			std::forward<Arg>(arg)
 		)
 	;
-
-	// Reset flags and width
-	stream.fill(orig.fill);
-	stream.flags(orig.flags);
-	if (0u != element.width) {
-		stream.width(orig.width);
-	}
-	if (-1 != element.precision) {
-		stream.precision(orig.precision);
+	if (flag_none != (restore_mask & next.mask)) {
+		out.stream.setf(out.flags, restore_mask & next.mask);
 	}
 }
 
 template<
-	Format const& format
+	Format const& format,
+	std::size_t index,
+	class Sink,
+	class Arg
 >
 inline void
-write_impl(
-	std::ostream& stream,
-	std::size_t const last_pos,
-	std::size_t const element_index
+write_element(
+	Sink& sink,
+	Arg&& arg
 ) {
-	Element const& element = format.elements[element_index];
-	stream.write(
-		format.string + last_pos,
-		static_cast<std::streamsize>(element.beg - last_pos)
-		+ (ElementType::esc == element.type)
+	Element const& element = format.elements[format.segments[index].element];
+	detail::write_fixed<detail::hex_fixed_digits(
+		format.elements[format.segments[index].element]
+	)>(
+		sink,
+		element,
+		format.string[element.end - 1u],
+		static_cast<typename detail::type_to_element<Arg>::cast>(
+			std::forward<Arg>(arg)
+		)
 	);
-	if (ElementType::end != element.type) {
-		write_impl<format>(
-			stream,
-			element.end,
-			element_index + 1u
+}
+
+template<
+	Format const& format
+>
+inline void
+write_literal(
+	StateStream<format>& out,
+	char const* const data,
+	std::size_t const size
+) {
+	out.stream.write(data, static_cast<std::streamsize>(size));
+}
+
+template<class Sink>
+inline void
+write_literal(
+	Sink& sink,
+	char const* const data,
+	std::size_t const size
+) {
+	detail::append_ref(sink, data, size);
+}
+
+template<
+	Format const& format,
+	std::size_t index,
+	class Out
+>
+inline void
+write_segment(
+	Out& out
+) {
+	Segment const& segment = format.segments[index];
+	if (0u != segment.size) {
+		write_literal(
+			out,
+			detail::literal_text<format>::data() + segment.beg,
+			segment.size
 		);
 	}
 }
 
 template<
 	Format const& format,
+	std::size_t index,
+	class Out
+>
+inline void
+write_impl(
+	Out& out
+) {
+	write_segment<format, index>(out);
+}
+
+template<
+	Format const& format,
+	std::size_t index,
+	class Out,
 	class ArgF,
 	class... ArgP
 >
 inline void
 write_impl(
-	std::ostream& stream,
-	std::size_t const last_pos,
-	std::size_t const element_index,
+	Out& out,
 	ArgF&& front,
 	ArgP&&... args
 ) {
-	Element const& element = format.elements[element_index];
-	stream.write(
-		format.string + last_pos,
-		static_cast<std::streamsize>(element.beg - last_pos)
-		+ (ElementType::esc == element.type)
+	write_segment<format, index>(out);
+	write_element<format, index>(
+		out,
+		std::forward<ArgF>(front)
 	);
-	if (ElementType::esc == element.type) {
-		write_impl<format>(
-			stream,
-			element.end,
-			element_index + 1u,
-			std::forward<ArgF>(front),
-			std::forward<ArgP>(args)...
-		);
-	} else {
-		write_element<format>(
-			stream,
+	write_impl<format, index + 1u>(
+		out,
+		std::forward<ArgP>(args)...
+	);
+}
+
+template<
+	Format const& format,
+	std::size_t index
+>
+inline std::size_t
+measure_impl() noexcept {
+	return format.segments[index].size;
+}
+
+template<
+	Format const& format,
+	std::size_t index,
+	class ArgF,
+	class... ArgP
+>
+inline std::size_t
+measure_impl(
+	ArgF&& front,
+	ArgP&&... args
+) {
+	Element const& element = format.elements[format.segments[index].element];
+	return
+		format.segments[index].size
+		+ detail::measure_value(
 			element,
-			std::forward<ArgF>(front)
-		);
-		write_impl<format>(
-			stream,
-			element.end,
-			element_index + 1u,
+			format.string[element.end - 1u],
+			static_cast<typename detail::type_to_element<ArgF>::cast>(
+				std::forward<ArgF>(front)
+			)
+		)
+		+ measure_impl<format, index + 1u>(
+			std::forward<ArgP>(args)...
+		)
+	;
+}
+
+template<
+	Format const& format,
+	class... ArgP
+>
+inline void
+check_args() noexcept {
+	static_assert(
+		sizeof...(ArgP) == format.literal_count,
+		"arguments do not match format"
+	);
+	static_assert(
+		detail::type_check<format, ArgP...>(),
+		"type of argument does not match element in format"
+	);
+}
+
+template<
+	Format const& format,
+	class Sink,
+	class... ArgP
+>
+inline typename std::enable_if<
+	!detail::sink_has_reserve<Sink>::value ||
+	detail::any_object<ArgP...>::value
+>::type
+reserve_hint(
+	Sink& /*sink*/,
+	ArgP&&... /*args*/
+) noexcept {}
+
+// NB: Objects are not measured, since that would render them twice
+template<
+	Format const& format,
+	class Sink,
+	class... ArgP
+>
+inline typename std::enable_if<
+	detail::sink_has_reserve<Sink>::value &&
+	!detail::any_object<ArgP...>::value
+>::type
+reserve_hint(
+	Sink& sink,
+	ArgP&&... args
+) {
+	sink.reserve(measure_impl<format, 0u>(std::forward<ArgP>(args)...));
+}
+
+// Whether a floating-point element takes the stream's precision
+template<
+	Format const& format
+>
+constexpr bool
+reads_precision(
+	std::size_t const index = 0u
+) noexcept {
+	return
+		format.literal_count > index && (
+			(
+				ElementType::flt
+				== format.elements[format.segments[index].element].type &&
+				-2 == value_state<format>(index).precision
+			) ||
+			reads_precision<format>(index + 1u)
+		)
+	;
+}
+
+// Whether the kernels output the same as the stream would, i.e., the
+// stream state that the format does not set is the default
+template<
+	Format const& format
+>
+inline bool
+stream_plain(
+	std::ostream const& stream
+) {
+	return
+		stream_classic(stream) &&
+		(!reads_precision<format>() || 6 == stream.precision())
+	;
+}
+
+// NB: A null C-string sets badbit when written to a stream
+template<class T>
+inline typename std::enable_if<
+	!detail::tte_string_charwise<T>() ||
+	std::is_array<detail::rm_ref_t<T>>::value,
+	bool
+>::type
+null_string(
+	T const& /*value*/
+) noexcept {
+	return false;
+}
+
+template<class T>
+inline typename std::enable_if<
+	detail::tte_string_charwise<T>() &&
+	!std::is_array<detail::rm_ref_t<T>>::value,
+	bool
+>::type
+null_string(
+	T const& value
+) noexcept {
+	return nullptr == value;
+}
+
+inline bool
+any_null_string() noexcept {
+	return false;
+}
+
+template<
+	class ArgF,
+	class... ArgP
+>
+inline bool
+any_null_string(
+	ArgF const& front,
+	ArgP const&... args
+) noexcept {
+	return null_string(front) || any_null_string(args...);
+}
+
+// Write record to the stream buffer under a single sentry, so a
+// unitbuf stream is flushed once. Like the stream's own output
+// functions, a short write sets badbit, and an exception sets badbit
+// and is rethrown if badbit is in exceptions().
+template<
+	Format const& format,
+	class... ArgP
+>
+inline void
+write_streambuf(
+	std::ostream& stream,
+	ArgP&&... args
+) {
+	std::ostream::sentry const sentry{stream};
+	if (!sentry) {
+		return;
+	}
+	StreambufSink sink{stream.rdbuf(), false};
+	try {
+		write_impl<format, 0u>(
+			sink,
 			std::forward<ArgP>(args)...
 		);
+	} catch (...) {
+		try {
+			stream.setstate(ios::badbit);
+		} catch (ios::failure const&) {}
+		if (ios::goodbit != (ios::badbit & stream.exceptions())) {
+			throw;
+		}
+		return;
+	}
+	if (sink.failed) {
+		stream.setstate(ios::badbit);
 	}
 }
 } // anonymous namespace
@@ -215,6 +705,12 @@ write_impl(
 /**
 	Write format to stream.
 
+	@remarks When the format takes no objects and the stream state it
+	does not set is the default (no width, no @c uppercase, precision
+	6 if used, and the classic locale), the record is written to the
+	stream buffer by the same kernels as format_to(), under a single
+	sentry. Otherwise each value is written to the stream.
+
 	@tparam format %Format.
 	@tparam ...ArgP Argument pack.
 	@param stream Stream to write to.
@@ -229,23 +725,237 @@ write(
 	std::ostream& stream,
 	ArgP&&... args
 ) {
-	static_assert(
-		sizeof...(ArgP) == format.literal_count,
-		"arguments do not match format"
+	check_args<format, ArgP...>();
+	if (
+		!detail::any_object<ArgP...>::value &&
+		stream_plain<format>(stream) &&
+		!any_null_string(args...)
+	) {
+		write_streambuf<format>(stream, std::forward<ArgP>(args)...);
+		return;
+	}
+	StateStream<format> out{stream};
+	write_impl<format, 0u>(
+		out,
+		std::forward<ArgP>(args)...
 	);
-	static_assert(
-		detail::type_check<format, ArgP...>(),
-		"type of argument does not match element in format"
+}
+
+/**
+	Write format to sink.
+
+	@remarks Output is the same as format_to(). If @a sink has a
+	reserve hint, it is given the size of the output first (unless
+	the format takes objects).
+
+	@tparam format %Format.
+	@tparam Sink Sink type (see sink.hpp).
+	@tparam ...ArgP Argument pack.
+	@param sink Sink to write to.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class Sink,
+	class... ArgP
+>
+inline typename std::enable_if<
+	!std::is_base_of<std::ostream, Sink>::value
+>::type
+write(
+	Sink& sink,
+	ArgP&&... args
+) {
+	check_args<format, ArgP...>();
+	reserve_hint<format>(sink, args...);
+	write_impl<format, 0u>(
+		sink,
+		std::forward<ArgP>(args)...
 	);
+}
 
-	write_impl<format>(
-		stream,
-		0u,
-		0u,
+/**
+	Result of format_to() and format_to_n().
+*/
+struct FormatToResult final {
+	/** End of written output; never past the end of the buffer. */
+	char* out;
+	/** Size of the full output (not truncated). */
+	std::size_t size;
+};
+
+/**
+	Write format to character buffer.
+
+	@note Output is truncated at @a last. No null terminator is
+	written.
+
+	@returns Pointer past the last character written and the size
+	of the full output.
+	@tparam format %Format.
+	@tparam ...ArgP Argument pack.
+	@param first Beginning of buffer.
+	@param last End of buffer.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class... ArgP
+>
+inline FormatToResult
+format_to(
+	char* const first,
+	char* const last,
+	ArgP&&... args
+) {
+	check_args<format, ArgP...>();
+	BufferSink sink{first, last, 0u};
+	write_impl<format, 0u>(
+		sink,
+		std::forward<ArgP>(args)...
+	);
+	return FormatToResult{sink.pos, sink.size};
+}
+
+/**
+	Write format to character buffer of at most @a n characters.
+
+	@returns Same as format_to().
+	@tparam format %Format.
+	@tparam ...ArgP Argument pack.
+	@param first Beginning of buffer.
+	@param n Size of buffer.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class... ArgP
+>
+inline FormatToResult
+format_to_n(
+	char* const first,
+	std::size_t const n,
+	ArgP&&... args
+) {
+	return format_to<format>(
+		first,
+		first + n,
 		std::forward<ArgP>(args)...
 	);
 }
 
+/**
+	Calculate size of formatted output.
+
+	@note Objects (non-string @c ElementType::str arguments) are
+	rendered to determine their size.
+
+	@returns Number of characters write() would output for @a args.
+	@tparam format %Format.
+	@tparam ...ArgP Argument pack.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class... ArgP
+>
+inline std::size_t
+formatted_size(
+	ArgP&&... args
+) {
+	check_args<format, ArgP...>();
+	return measure_impl<format, 0u>(
+		std::forward<ArgP>(args)...
+	);
+}
+
+/** @cond INTERNAL */
+namespace detail {
+
+template<class S>
+struct is_char_string
+	: std::is_same<S, String>
+{};
+
+template<class Traits, class Allocator>
+struct is_char_string<std::basic_string<char, Traits, Allocator>>
+	: std::true_type
+{};
+
+template<
+	class Allocator,
+	class = void
+>
+struct is_char_allocator
+	: std::false_type
+{};
+
+template<class Allocator>
+struct is_char_allocator<
+	Allocator,
+	typename std::enable_if<
+		std::is_same<char, typename Allocator::value_type>::value &&
+		std::is_same<
+			char*,
+			decltype(std::declval<Allocator&>().allocate(std::size_t{1u}))
+		>::value
+	>::type
+>
+	: std::true_type
+{};
+
+} // namespace detail
+/** @endcond */ // INTERNAL
+
+/**
+	Append format to string.
+
+	@remarks @a out is grown at most once unless the format takes
+	objects (non-string @c ElementType::str arguments). Existing
+	capacity is reused, so clearing and reusing a string across calls
+	avoids allocation.
+
+	@returns @a out.
+	@tparam format %Format.
+	@tparam S String type; String or a @c std::basic_string of
+	@c char with any allocator.
+	@tparam ...ArgP Argument pack.
+	@param out String to append to.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class S,
+	class... ArgP
+>
+inline typename std::enable_if<
+	detail::is_char_string<S>::value,
+	S&
+>::type
+print_to(
+	S& out,
+	ArgP&&... args
+) {
+	check_args<format, ArgP...>();
+	if (detail::any_object<ArgP...>::value) {
+		// Objects are rendered once, directly into the string
+		BasicStringSink<S> sink{out};
+		write_impl<format, 0u>(
+			sink,
+			std::forward<ArgP>(args)...
+		);
+	} else {
+		std::size_t const pos = out.size();
+		out.resize(pos + formatted_size<format>(args...));
+		format_to<format>(
+			&out[0] + pos,
+			&out[0] + out.size(),
+			std::forward<ArgP>(args)...
+		);
+	}
+	return out;
+}
+
 /**
 	Write format to string.
 
@@ -262,30 +972,171 @@ inline String
 print(
 	ArgP&&... args
 ) {
-	OutputStringStream stream;
-	// Ensure stream does not flush after every output operation
-	stream.flags(stream.flags() & ~ios::unitbuf);
-	write<format>(
-		stream,
+	String str;
+	print_to<format>(
+		str,
+		std::forward<ArgP>(args)...
+	);
+	return str;
+}
+
+/**
+	Write format to string with allocator.
+
+	@remarks This allocates with @a allocator only; objects
+	(non-string @c ElementType::str arguments) are rendered with
+	OutputStringStream first.
+
+	@returns Formatted string.
+	@tparam format %Format.
+	@tparam Allocator Allocator of @c char.
+	@tparam ...ArgP Argument pack.
+	@param allocator Allocator for the string.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class Allocator,
+	class... ArgP
+>
+inline typename std::enable_if<
+	detail::is_char_allocator<detail::rm_cref_t<Allocator>>::value,
+	std::basic_string<char, std::char_traits<char>, detail::rm_cref_t<Allocator>>
+>::type
+print(
+	Allocator&& allocator,
+	ArgP&&... args
+) {
+	std::basic_string<
+		char, std::char_traits<char>, detail::rm_cref_t<Allocator>
+	> str{std::forward<Allocator>(allocator)};
+	print_to<format>(
+		str,
 		std::forward<ArgP>(args)...
 	);
-	return stream.str();
+	return str;
 }
 
+#if CEFORMAT_CONFIG_PMR
+/**
+	Write format to string with memory resource.
+
+	@remarks Same as print() with a
+	@c std::pmr::polymorphic_allocator of @a resource.
+
+	@returns Formatted string.
+	@tparam format %Format.
+	@tparam Resource Type derived from @c std::pmr::memory_resource.
+	@tparam ...ArgP Argument pack.
+	@param resource Memory resource for the string.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class Resource,
+	class... ArgP
+>
+inline typename std::enable_if<
+	std::is_base_of<std::pmr::memory_resource, Resource>::value,
+	std::pmr::string
+>::type
+print(
+	Resource& resource,
+	ArgP&&... args
+) {
+	return print<format>(
+		std::pmr::polymorphic_allocator<char>{&resource},
+		std::forward<ArgP>(args)...
+	);
+}
+#endif // CEFORMAT_CONFIG_PMR
+
 /** @cond INTERNAL */
-//namespace {
+namespace detail {
+inline String&
+scratch_string() {
+	static thread_local String s_scratch;
+	return s_scratch;
+}
+} // namespace detail
+/** @endcond */ // INTERNAL
+
+/**
+	Write format to thread-local scratch string.
+
+	@warning The view is only valid until the next call to
+	print_view() on the same thread. This must not be called while
+	formatting another print_view() (e.g., from an object's
+	@c operator<<).
+
+	@remarks The scratch string is reused, so once it has grown to
+	fit the largest output this does not allocate (except to render
+	objects).
+
+	@returns View of the formatted string.
+	@tparam format %Format.
+	@tparam ...ArgP Argument pack.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	class... ArgP
+>
+inline StringView
+print_view(
+	ArgP&&... args
+) {
+	String& scratch = detail::scratch_string();
+	scratch.clear();
+	print_to<format>(
+		scratch,
+		std::forward<ArgP>(args)...
+	);
+	return StringView(scratch.data(), scratch.size());
+}
+
+/** @cond INTERNAL */
+template<
+	Format const& format,
+	class... ArgP
+>
 struct FormatSentinel final {
-	using lambda_type = std::function<void(std::ostream&)>;
-	lambda_type lambda;
+	std::tuple<ArgP&&...> args;
 };
-//} // anonymous namespace
 
+namespace {
+template<
+	Format const& format,
+	class... ArgP,
+	std::size_t... I
+>
+inline void
+write_sentinel_impl(
+	std::ostream& stream,
+	FormatSentinel<format, ArgP...> const& sentinel,
+	detail::index_sequence<I...>
+) {
+	ceformat::write<format>(
+		stream,
+		std::get<I>(sentinel.args)...
+	);
+}
+} // anonymous namespace
+
+template<
+	Format const& format,
+	class... ArgP
+>
 inline std::ostream&
 operator<<(
 	std::ostream& stream,
-	FormatSentinel const& sentinel
+	FormatSentinel<format, ArgP...> const& sentinel
 ) {
-	sentinel.lambda(stream);
+	write_sentinel_impl(
+		stream,
+		sentinel,
+		detail::make_index_sequence<sizeof...(ArgP)>{}
+	);
 	return stream;
 }
 /** @endcond */
@@ -307,22 +1158,13 @@ template<
 	Format const& format,
 	class... ArgP
 >
-inline FormatSentinel
+inline FormatSentinel<format, ArgP...>
 write_sentinel(
 	ArgP&&... args
 ) {
-	// FIXME: Haha, neat. Defect in Clang 3.4 construes [&args...] as
-	// the GNU array range extension if the lambda is surrounded by {}
-	return FormatSentinel{FormatSentinel::lambda_type(
-		[&args...](
-			std::ostream& stream
-		) {
-			ceformat::write<format>(
-				stream,
-				args...
-			);
-		}
-	)};
+	return FormatSentinel<format, ArgP...>{
+		std::tuple<ArgP&&...>{std::forward<ArgP>(args)...}
+	};
 }
 
 /** @} */ // end of doc-group print
@@ -0,0 +1,352 @@
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+
+@file
+@brief Record ring buffer.
+*/
+
+#pragma once
+
+#include <ceformat/config.hpp>
+#include <ceformat/Format.hpp>
+#include <ceformat/print.hpp>
+#include <ceformat/sink.hpp>
+
+#include <utility>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace ceformat {
+
+/**
+	@addtogroup print
+	@{
+*/
+
+/**
+	Space reserved in a RecordRing.
+*/
+struct RecordSlot final {
+	/** Start of space; @c nullptr if nothing was reserved. */
+	char* data;
+	/** Size of space. */
+	std::size_t size;
+	/** @cond INTERNAL */
+	std::size_t unit;
+	/** @endcond */
+};
+
+/**
+	Bounded multi-producer single-consumer ring of records.
+
+	Producers reserve() space for a record, write it in place and
+	commit() it (or cancel() it); write_record() does this for a
+	format. A single
+	consumer drains committed records in reservation order.
+
+	Reserving is a single compare-and-swap of the head position when
+	producers do not collide (lock-free otherwise); committing is a
+	single store. A record is contiguous in the ring; at most half of
+	the capacity.
+
+	@warning Every reserved slot must be committed or cancelled, since
+	the consumer stops at the first uncommitted record.
+
+	@tparam capacity Size of the ring in bytes; a power of two of at
+	least 64.
+*/
+template<std::size_t capacity>
+class RecordRing final {
+	static_assert(
+		64u <= capacity && 0u == (capacity & (capacity - 1u)),
+		"capacity must be a power of two of at least 64"
+	);
+	static_assert(
+		UINT32_MAX / 2u >= capacity,
+		"capacity must be less than 2^31"
+	);
+
+public:
+	/** Largest record size. */
+	static constexpr std::size_t const
+	record_max = capacity / 2u;
+
+private:
+	enum : std::size_t {
+		UNIT = 8u,
+	};
+	// NB: Record marks are at most record_max + 1, below MARK_GAP
+	enum : std::uint32_t {
+		MARK_EMPTY = 0u,
+		MARK_GAP = UINT32_C(1) << 31u,
+		MARK_PAD = UINT32_MAX,
+	};
+
+	// NB: Positions and producer counters are kept on separate cache
+	// lines (padded rather than aligned, so the ring can be allocated
+	// with new prior to C++17)
+	std::atomic<std::uint64_t> m_head;
+	char m_pad_head[64u];
+	std::atomic<std::uint64_t> m_tail;
+	char m_pad_tail[64u];
+	std::atomic<std::size_t> m_dropped;
+	std::atomic<std::size_t> m_overflow;
+	char m_pad_count[64u];
+	// Committed size + 1 of the record starting at each unit,
+	// MARK_GAP | units of unused space, or another MARK_* value
+	std::atomic<std::uint32_t> m_marks[capacity / UNIT];
+	alignas(UNIT) char m_data[capacity];
+
+	static constexpr std::size_t
+	stride(
+		std::size_t const size
+	) noexcept {
+		return
+			0u == size
+			? UNIT
+			: (size + UNIT - 1u) & ~(UNIT - 1u)
+		;
+	}
+
+public:
+	RecordRing(RecordRing const&) = delete;
+	RecordRing& operator=(RecordRing const&) = delete;
+
+	/** Construct empty ring. */
+	RecordRing() noexcept
+		: m_head(0u)
+		, m_tail(0u)
+		, m_dropped(0u)
+		, m_overflow(0u)
+	{
+		for (auto& mark : this->m_marks) {
+			mark.store(MARK_EMPTY, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+		Get number of records dropped because the ring was full.
+	*/
+	std::size_t
+	dropped_count() const noexcept {
+		return this->m_dropped.load(std::memory_order_relaxed);
+	}
+
+	/**
+		Get number of records dropped because they were larger than
+		@c record_max.
+	*/
+	std::size_t
+	overflow_count() const noexcept {
+		return this->m_overflow.load(std::memory_order_relaxed);
+	}
+
+	/**
+		Reserve space for record.
+
+		@returns Slot of @a size bytes, or a slot with a @c nullptr
+		@c data if the ring is full or @a size is larger than
+		@c record_max (counted by dropped_count() and
+		overflow_count()).
+		@param size Size of record.
+	*/
+	RecordSlot
+	reserve(
+		std::size_t const size
+	) noexcept {
+		if (record_max < size) {
+			this->m_overflow.fetch_add(1u, std::memory_order_relaxed);
+			return RecordSlot{nullptr, 0u, 0u};
+		}
+		std::size_t const need = stride(size);
+		std::uint64_t head = this->m_head.load(std::memory_order_relaxed);
+		std::size_t offset;
+		std::size_t pad;
+		do {
+			// Records do not wrap; the end of the ring is padded instead
+			offset = static_cast<std::size_t>(head & (capacity - 1u));
+			pad = capacity - offset < need ? capacity - offset : 0u;
+			if (
+				head + pad + need
+				- this->m_tail.load(std::memory_order_acquire)
+				> capacity
+			) {
+				this->m_dropped.fetch_add(1u, std::memory_order_relaxed);
+				return RecordSlot{nullptr, 0u, 0u};
+			}
+		} while (!this->m_head.compare_exchange_weak(
+			head, head + pad + need,
+			std::memory_order_relaxed,
+			std::memory_order_relaxed
+		));
+		if (0u != pad) {
+			this->m_marks[offset / UNIT].store(MARK_PAD, std::memory_order_release);
+			offset = 0u;
+		}
+		return RecordSlot{this->m_data + offset, size, offset / UNIT};
+	}
+
+	/**
+		Commit record.
+
+		@param slot Slot from reserve() with a non-null @c data.
+		@param size Size of record; at most the size of @a slot. The
+		rest of the slot is skipped by the consumer.
+	*/
+	void
+	commit(
+		RecordSlot const& slot,
+		std::size_t const size
+	) noexcept {
+		assert(slot.size >= size);
+		std::size_t const gap = stride(slot.size) - stride(size);
+		if (0u != gap) {
+			this->m_marks[slot.unit + stride(size) / UNIT].store(
+				MARK_GAP | static_cast<std::uint32_t>(gap / UNIT),
+				std::memory_order_relaxed
+			);
+		}
+		this->m_marks[slot.unit].store(
+			static_cast<std::uint32_t>(size + 1u),
+			std::memory_order_release
+		);
+	}
+
+	/**
+		Commit record with the size of its slot.
+
+		@param slot Slot from reserve() with a non-null @c data.
+	*/
+	void
+	commit(
+		RecordSlot const& slot
+	) noexcept {
+		this->commit(slot, slot.size);
+	}
+
+	/**
+		Cancel record.
+
+		@remarks The slot is skipped by the consumer, so nothing is
+		drained for it.
+
+		@param slot Slot from reserve() with a non-null @c data.
+	*/
+	void
+	cancel(
+		RecordSlot const& slot
+	) noexcept {
+		this->m_marks[slot.unit].store(
+			MARK_GAP | static_cast<std::uint32_t>(stride(slot.size) / UNIT),
+			std::memory_order_release
+		);
+	}
+
+	/**
+		Drain committed records to sink.
+
+		@warning Only one thread may drain the ring.
+
+		@returns Number of records drained.
+		@param sink Sink (see sink.hpp); each record is appended
+		whole.
+	*/
+	template<class Sink>
+	std::size_t
+	drain(
+		Sink& sink
+	) {
+		std::size_t count = 0u;
+		std::uint64_t tail = this->m_tail.load(std::memory_order_relaxed);
+		for (;;) {
+			std::size_t const offset = static_cast<std::size_t>(tail & (capacity - 1u));
+			std::atomic<std::uint32_t>& mark = this->m_marks[offset / UNIT];
+			std::uint32_t const value = mark.load(std::memory_order_acquire);
+			if (MARK_EMPTY == value) {
+				break;
+			}
+			mark.store(MARK_EMPTY, std::memory_order_relaxed);
+			if (MARK_PAD == value) {
+				tail += capacity - offset;
+			} else if (MARK_GAP <= value) {
+				tail += (value & ~MARK_GAP) * UNIT;
+			} else {
+				sink.append(this->m_data + offset, value - 1u);
+				tail += stride(value - 1u);
+				++count;
+			}
+			this->m_tail.store(tail, std::memory_order_release);
+		}
+		return count;
+	}
+};
+
+/** @cond INTERNAL */
+namespace detail {
+
+// Cancels a slot unless it was committed, so that an exception thrown
+// while writing the record doesn't stall the ring
+template<std::size_t capacity>
+struct RecordGuard final {
+	RecordRing<capacity>& ring;
+	RecordSlot const& slot;
+	bool committed;
+
+	~RecordGuard() {
+		if (!this->committed) {
+			this->ring.cancel(this->slot);
+		}
+	}
+};
+
+} // namespace detail
+/** @endcond */ // INTERNAL
+
+/**
+	Write format to ring as a record.
+
+	@remarks Output is measured, then written in place to the reserved
+	record with the same kernels as format_to(). The record holds what
+	was written, which is truncated if an object renders longer than
+	measured. If writing throws, the record is cancelled.
+
+	@returns @c true if the record was written; @c false if it was
+	dropped.
+	@tparam format %Format.
+	@tparam ...ArgP Argument pack.
+	@param ring Ring to write to.
+	@param args Arguments.
+*/
+template<
+	Format const& format,
+	std::size_t capacity,
+	class... ArgP
+>
+inline bool
+write_record(
+	RecordRing<capacity>& ring,
+	ArgP&&... args
+) {
+	check_args<format, ArgP...>();
+	RecordSlot const slot = ring.reserve(
+		measure_impl<format, 0u>(args...)
+	);
+	if (nullptr == slot.data) {
+		return false;
+	}
+	detail::RecordGuard<capacity> guard{ring, slot, false};
+	BufferSink sink{slot.data, slot.data + slot.size, 0u};
+	write_impl<format, 0u>(
+		sink,
+		std::forward<ArgP>(args)...
+	);
+	ring.commit(slot, static_cast<std::size_t>(sink.pos - slot.data));
+	guard.committed = true;
+	return true;
+}
+
+/** @} */ // end of doc-group print
+
+} // namespace ceformat
@@ -0,0 +1,385 @@
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+
+@file
+@brief Output sinks.
+*/
+
+#pragma once
+
+#include <ceformat/config.hpp>
+#include <ceformat/String.hpp>
+
+#include <type_traits>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <streambuf>
+
+namespace ceformat {
+
+/**
+	@addtogroup print
+	@{
+*/
+
+/**
+	@name Sinks
+
+	A sink is any type providing:
+
+	@code
+	void append(char const* data, std::size_t size);
+	void append(char value, std::size_t count);
+	@endcode
+
+	and optionally a reserve hint, which is given the size of the
+	output to come before it is appended:
+
+	@code
+	void reserve(std::size_t size);
+	@endcode
+
+	It can also provide an append for data which outlives the output
+	(literal text and string arguments), so the data can be referenced
+	instead of copied (see IovecSink):
+
+	@code
+	void append_ref(char const* data, std::size_t size);
+	@endcode
+
+	Output to a sink is the same as format_to(); it does not depend on
+	the state of any stream.
+
+	@{
+*/
+
+/**
+	Sink writing to a bounded character range.
+
+	@note Output is truncated at @c last, but @c size counts the full
+	output.
+*/
+struct BufferSink final {
+	/** Position of the next character. */
+	char* pos;
+	/** End of range. */
+	char* const last;
+	/** Size of output (not truncated). */
+	std::size_t size;
+
+	/** Append characters. */
+	void
+	append(
+		char const* const data,
+		std::size_t const count
+	) noexcept {
+		std::size_t const avail = static_cast<std::size_t>(this->last - this->pos);
+		std::size_t const copy = count < avail ? count : avail;
+		std::memcpy(this->pos, data, copy);
+		this->pos += copy;
+		this->size += count;
+	}
+
+	/** Append @a count copies of @a value. */
+	void
+	append(
+		char const value,
+		std::size_t const count
+	) noexcept {
+		std::size_t const avail = static_cast<std::size_t>(this->last - this->pos);
+		std::size_t const copy = count < avail ? count : avail;
+		std::memset(this->pos, value, copy);
+		this->pos += copy;
+		this->size += count;
+	}
+};
+
+/**
+	Make sink writing to a character array.
+
+	@returns Sink for @a buffer.
+	@param buffer Array.
+*/
+template<std::size_t N>
+inline BufferSink
+array_sink(
+	char (&buffer)[N]
+) noexcept {
+	return BufferSink{buffer, buffer + N, 0u};
+}
+
+/**
+	Sink appending to a string.
+
+	@tparam S String type; a @c std::basic_string of @c char or
+	String.
+*/
+template<class S>
+struct BasicStringSink final {
+	/** String. */
+	S& str;
+
+	/** Append characters. */
+	void
+	append(
+		char const* const data,
+		std::size_t const count
+	) {
+		this->str.append(data, count);
+	}
+
+	/** Append @a count copies of @a value. */
+	void
+	append(
+		char const value,
+		std::size_t const count
+	) {
+		this->str.append(count, value);
+	}
+
+	/**
+		Reserve space for @a count more characters.
+
+		@remarks Capacity grows geometrically, so reserving before
+		each append does not make appending quadratic.
+	*/
+	void
+	reserve(
+		std::size_t const count
+	) {
+		std::size_t const size = this->str.size() + count;
+		if (this->str.capacity() < size) {
+			this->str.reserve(
+				2u * this->str.capacity() > size
+				? 2u * this->str.capacity()
+				: size
+			);
+		}
+	}
+};
+
+/**
+	Sink appending to a String.
+*/
+using StringSink = BasicStringSink<String>;
+
+/**
+	Sink appending to a character vector.
+*/
+struct VectorSink final {
+	/** Vector. */
+	std::vector<char>& vec;
+
+	/** Append characters. */
+	void
+	append(
+		char const* const data,
+		std::size_t const count
+	) {
+		this->vec.insert(this->vec.end(), data, data + count);
+	}
+
+	/** Append @a count copies of @a value. */
+	void
+	append(
+		char const value,
+		std::size_t const count
+	) {
+		this->vec.insert(this->vec.end(), count, value);
+	}
+
+	/** Reserve space for @a count more characters (see BasicStringSink). */
+	void
+	reserve(
+		std::size_t const count
+	) {
+		std::size_t const size = this->vec.size() + count;
+		if (this->vec.capacity() < size) {
+			this->vec.reserve(
+				2u * this->vec.capacity() > size
+				? 2u * this->vec.capacity()
+				: size
+			);
+		}
+	}
+};
+
+/**
+	Sink counting output size.
+*/
+struct CountingSink final {
+	/** Size of output. */
+	std::size_t size;
+
+	/** Count characters. */
+	void
+	append(
+		char const* const,
+		std::size_t const count
+	) noexcept {
+		this->size += count;
+	}
+
+	/** Count characters. */
+	void
+	append(
+		char const,
+		std::size_t const count
+	) noexcept {
+		this->size += count;
+	}
+};
+
+/**
+	Sink writing to a stream.
+
+	@note The formatting state of the stream is neither used nor
+	changed.
+*/
+struct StreamSink final {
+	/** Stream. */
+	std::ostream& stream;
+
+	/** Append characters. */
+	void
+	append(
+		char const* const data,
+		std::size_t const count
+	) {
+		this->stream.write(data, static_cast<std::streamsize>(count));
+	}
+
+	/** Append @a count copies of @a value. */
+	void
+	append(
+		char const value,
+		std::size_t count
+	) {
+		char fill[32u];
+		std::memset(fill, value, count < sizeof(fill) ? count : sizeof(fill));
+		while (0u < count) {
+			std::size_t const chunk = count < sizeof(fill) ? count : sizeof(fill);
+			this->stream.write(fill, static_cast<std::streamsize>(chunk));
+			count -= chunk;
+		}
+	}
+};
+
+/**
+	Sink writing to a stream buffer.
+
+	@note Output stops at the first short write, which sets
+	@c failed. The stream buffer is written directly, so no stream
+	state is checked or set.
+*/
+struct StreambufSink final {
+	/** Stream buffer. */
+	std::streambuf* const buf;
+	/** Whether a write was short. */
+	bool failed;
+
+	/** Append characters. */
+	void
+	append(
+		char const* const data,
+		std::size_t const count
+	) {
+		if (
+			!this->failed &&
+			static_cast<std::streamsize>(count)
+			!= this->buf->sputn(data, static_cast<std::streamsize>(count))
+		) {
+			this->failed = true;
+		}
+	}
+
+	/** Append @a count copies of @a value. */
+	void
+	append(
+		char const value,
+		std::size_t count
+	) {
+		using traits = std::streambuf::traits_type;
+		for (; 0u < count && !this->failed; --count) {
+			if (traits::eq_int_type(traits::eof(), this->buf->sputc(value))) {
+				this->failed = true;
+			}
+		}
+	}
+};
+
+/** @} */ // end of name Sinks
+
+/** @cond INTERNAL */
+namespace detail {
+
+template<
+	class Sink,
+	class = void
+>
+struct sink_has_reserve {
+	static constexpr bool
+	value = false;
+};
+
+template<class Sink>
+struct sink_has_reserve<
+	Sink,
+	decltype(std::declval<Sink&>().reserve(std::size_t{0u}))
+> {
+	static constexpr bool
+	value = true;
+};
+
+template<
+	class Sink,
+	class = void
+>
+struct sink_has_append_ref {
+	static constexpr bool
+	value = false;
+};
+
+template<class Sink>
+struct sink_has_append_ref<
+	Sink,
+	decltype(std::declval<Sink&>().append_ref(
+		static_cast<char const*>(nullptr), std::size_t{0u}
+	))
+> {
+	static constexpr bool
+	value = true;
+};
+
+template<class Sink>
+inline typename std::enable_if<
+	sink_has_append_ref<Sink>::value
+>::type
+append_ref(
+	Sink& sink,
+	char const* const data,
+	std::size_t const size
+) {
+	sink.append_ref(data, size);
+}
+
+template<class Sink>
+inline typename std::enable_if<
+	!sink_has_append_ref<Sink>::value
+>::type
+append_ref(
+	Sink& sink,
+	char const* const data,
+	std::size_t const size
+) {
+	sink.append(data, size);
+}
+
+} // namespace detail
+/** @endcond */ // INTERNAL
+
+/** @} */ // end of doc-group print
+
+} // namespace ceformat
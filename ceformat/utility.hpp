@@ -41,13 +41,15 @@ min_ce(
 namespace {
 constexpr std::size_t
 digit_count_impl(
-	std::size_t const value,
+	unsigned long long const value,
+	unsigned const base,
 	std::size_t const count
 ) noexcept {
 	return
 	0 != value
 		? digit_count_impl(
-			value / 10,
+			value / base,
+			base,
 			count + 1u
 		)
 	: count
@@ -63,18 +65,93 @@ digit_count_impl(
 
 	@returns The number of digits in @a value.
 	@param value Value.
+	@param base Numeric base.
 */
 constexpr std::size_t
 digit_count(
-	std::size_t const value
+	unsigned long long const value,
+	unsigned const base = 10u
 ) noexcept {
 	return
 	digit_count_impl(
 		value,
-		static_cast<unsigned>(0u == value)
+		base,
+		static_cast<std::size_t>(0u == value)
 	);
 }
 
+/** @cond INTERNAL */
+namespace {
+constexpr std::size_t
+find_char_join(
+	char const* const string,
+	char const value,
+	std::size_t const first,
+	std::size_t const mid,
+	std::size_t const end
+) noexcept;
+} // anonymous namespace
+/** @endcond */ // INTERNAL
+
+/**
+	Find character in a range of a string.
+
+	@note Recursion depth is logarithmic in the size of the range.
+
+	@returns Position of the first @a value in [@a beg, @a end), or
+	@a end if there is none.
+	@param string String.
+	@param value Character to find.
+	@param beg Beginning position.
+	@param end Ending position.
+*/
+constexpr std::size_t
+find_char(
+	char const* const string,
+	char const value,
+	std::size_t const beg,
+	std::size_t const end
+) noexcept {
+	return false ? 0u
+	: beg >= end
+		? end
+
+	// Linear for short ranges
+	: 8u >= end - beg
+		? value == string[beg]
+			? beg
+			: find_char(string, value, beg + 1u, end)
+
+	// Search the first half before the second
+	: find_char_join(
+		string,
+		value,
+		find_char(string, value, beg, beg + (end - beg) / 2u),
+		beg + (end - beg) / 2u,
+		end
+	)
+	;
+}
+
+/** @cond INTERNAL */
+namespace {
+constexpr std::size_t
+find_char_join(
+	char const* const string,
+	char const value,
+	std::size_t const first,
+	std::size_t const mid,
+	std::size_t const end
+) noexcept {
+	return
+		mid != first
+		? first
+		: find_char(string, value, mid, end)
+	;
+}
+} // anonymous namespace
+/** @endcond */ // INTERNAL
+
 /** @} */ // end of doc-group utility
 
 } // namespace utility
@@ -14,5 +14,6 @@ precore.init(
 
 precore.import(".")
 precore.import("test")
+precore.import("tool")
 
 precore.action_clean("out")
@@ -0,0 +1,613 @@
+
+#include <ceformat/Format.hpp>
+#include <ceformat/print.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__has_include)
+	#if __has_include(<version>)
+		#include <version>
+	#endif
+#endif
+
+#if defined(__cpp_lib_format)
+	#include <format>
+	#define CEFORMAT_BENCH_STD_FORMAT 1
+#else
+	#define CEFORMAT_BENCH_STD_FORMAT 0
+#endif
+
+namespace cf = ceformat;
+
+static constexpr cf::Format const
+	// Formats from test/general/format.cpp
+	all{"%% %d %u %#x %#o %f %s %c"},
+	flags{"%+-2d %u %#x %#o %f %b %#08p %#p"},
+	align{"[%-4d] [%4u] [%-#6x] [%#4o] [%07.2f] [%-10b] [%#016p]"},
+	floats{"%f/%#f %e/%#e %g/%#g %g %g %g %010f %010.4f %f %.4f"},
+
+	// Per-element-type
+	type_dec{"%d"},
+	type_uns{"%u"},
+	type_hex{"%#x"},
+	type_oct{"%#o"},
+	type_flt_f{"%f"},
+	type_flt_e{"%e"},
+	type_flt_g{"%g"},
+	type_str{"%s"},
+	type_chr{"%c"},
+	type_ptr{"%p"},
+	type_bool{"%b"},
+
+	// Report
+	row_text{"%-10s %-26s %6u %10.1f %10.1f %10.1f %10.1f %10.1f\n"},
+	row_json{
+		"    {\"group\": \"%s\", \"impl\": \"%s\", \"bytes\": %u, "
+		"\"ns\": {\"min\": %.1f, \"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f}, "
+		"\"bytes_per_sec\": %.0f}"
+	}
+;
+
+// Arguments are read from mutable globals so that calls can not be
+// folded into constants
+signed arg_dec = -123456789;
+unsigned arg_uns = 3735928559u;
+signed arg_small = 42;
+unsigned arg_small_uns = 42u;
+float arg_float = 3.14f;
+double arg_double = 3.14159265358979;
+double arg_sum = 0.1 + 0.2;
+char const* arg_str = "string";
+char arg_chr = 'A';
+bool arg_bool = true;
+void const* arg_ptr = &arg_dec;
+
+enum : std::size_t {
+	BUFFER_SIZE = 512u,
+};
+
+class CountingBuffer final
+	: public std::streambuf
+{
+	char m_buffer[BUFFER_SIZE];
+	std::size_t m_count{0u};
+
+public:
+	CountingBuffer() {
+		setp(m_buffer, m_buffer + sizeof(m_buffer));
+	}
+
+	std::size_t
+	count() const noexcept {
+		return m_count + static_cast<std::size_t>(pptr() - pbase());
+	}
+
+protected:
+	int_type
+	overflow(
+		int_type const c
+	) override {
+		m_count += static_cast<std::size_t>(pptr() - pbase()) + 1u;
+		setp(m_buffer, m_buffer + sizeof(m_buffer));
+		return traits_type::not_eof(c);
+	}
+
+	std::streamsize
+	xsputn(
+		char const* const,
+		std::streamsize const n
+	) override {
+		m_count += static_cast<std::size_t>(n);
+		return n;
+	}
+};
+
+struct StateGuard final {
+	std::ostream& stream;
+	std::ios_base::fmtflags const flags;
+	std::streamsize const precision;
+	char const fill;
+
+	StateGuard(
+		std::ostream& stream
+	)
+		: stream(stream)
+		, flags(stream.flags())
+		, precision(stream.precision())
+		, fill(stream.fill())
+	{}
+
+	~StateGuard() {
+		stream.flags(flags);
+		stream.precision(precision);
+		stream.fill(fill);
+	}
+};
+
+struct Result final {
+	char const* group;
+	char const* impl;
+	std::size_t bytes;
+	double min;
+	double p50;
+	double p90;
+	double p99;
+};
+
+class Bench final {
+	using Clock = std::chrono::steady_clock;
+
+	std::size_t const m_samples;
+	double const m_sample_ns;
+	CountingBuffer m_buffer{};
+	std::ostream m_stream{&m_buffer};
+	char m_chars[BUFFER_SIZE];
+	std::size_t volatile m_sink{0u};
+	std::vector<Result> m_results{};
+
+	template<class F>
+	double
+	time(
+		F& f,
+		std::size_t const iterations
+	) {
+		std::size_t sum = 0u;
+		auto const start = Clock::now();
+		for (std::size_t i = 0u; iterations > i; ++i) {
+			sum += f();
+		}
+		auto const end = Clock::now();
+		m_sink = m_sink + sum;
+		return static_cast<double>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(
+				end - start
+			).count()
+		);
+	}
+
+public:
+	Bench(
+		std::size_t const samples,
+		double const sample_ns
+	)
+		: m_samples(samples)
+		, m_sample_ns(sample_ns)
+	{}
+
+	std::ostream&
+	stream() noexcept {
+		return m_stream;
+	}
+
+	std::size_t
+	count() const noexcept {
+		return m_buffer.count();
+	}
+
+	char*
+	chars() noexcept {
+		return m_chars;
+	}
+
+	std::vector<Result> const&
+	results() const noexcept {
+		return m_results;
+	}
+
+	// f returns the number of bytes produced by one call
+	template<class F>
+	void
+	run(
+		char const* const group,
+		char const* const impl,
+		F f
+	) {
+		std::size_t const bytes = f();
+		std::size_t iterations = 1u;
+		while (
+			(1u << 24u) > iterations &&
+			m_sample_ns > time(f, iterations)
+		) {
+			iterations *= 2u;
+		}
+		std::vector<double> ns;
+		ns.reserve(m_samples);
+		for (std::size_t s = 0u; m_samples > s; ++s) {
+			ns.push_back(time(f, iterations) / static_cast<double>(iterations));
+		}
+		std::sort(ns.begin(), ns.end());
+		auto const at = [&ns](double const p) {
+			return ns[static_cast<std::size_t>(p * static_cast<double>(ns.size() - 1u))];
+		};
+		m_results.push_back(Result{
+			group, impl, bytes, ns.front(), at(0.50), at(0.90), at(0.99)
+		});
+	}
+
+	// f writes to its stream argument
+	template<class F>
+	void
+	run_stream(
+		char const* const group,
+		F f
+	) {
+		run(group, "std::ostream", [this, &f]() {
+			std::size_t const before = m_buffer.count();
+			{
+				StateGuard const guard{m_stream};
+				f(m_stream);
+			}
+			return m_buffer.count() - before;
+		});
+		run(group, "std::ostringstream", [&f]() {
+			std::ostringstream stream;
+			f(stream);
+			return stream.str().size();
+		});
+	}
+
+	// f writes to its buffer argument and returns the size
+	template<class F>
+	void
+	run_chars(
+		char const* const group,
+		char const* const impl,
+		F f
+	) {
+		run(group, impl, [this, &f]() {
+			return static_cast<std::size_t>(f(m_chars));
+		});
+	}
+};
+
+template<
+	cf::Format const& format,
+	class... ArgP
+>
+void
+bench_ceformat(
+	Bench& bench,
+	char const* const group,
+	ArgP const&... args
+) {
+	bench.run(group, "ceformat::write", [&bench, &args...]() {
+		std::size_t const before = bench.count();
+		cf::write<format>(bench.stream(), args...);
+		return bench.count() - before;
+	});
+	bench.run(group, "ceformat::write_sentinel", [&bench, &args...]() {
+		std::size_t const before = bench.count();
+		bench.stream() << cf::write_sentinel<format>(args...);
+		return bench.count() - before;
+	});
+	bench.run(group, "ceformat::print", [&args...]() {
+		return cf::print<format>(args...).size();
+	});
+	bench.run(group, "ceformat::format_to", [&bench, &args...]() {
+		return cf::format_to<format>(
+			bench.chars(), bench.chars() + BUFFER_SIZE, args...
+		).size;
+	});
+}
+
+#define BENCH_SNPRINTF(group_, ...)								\
+	bench.run_chars(group_, "snprintf", [](char* const buffer) {	\
+		return std::snprintf(buffer, BUFFER_SIZE, __VA_ARGS__);		\
+	})
+
+#if CEFORMAT_BENCH_STD_FORMAT
+	#define BENCH_STD_FORMAT(group_, ...)								\
+		bench.run(group_, "std::format", []() {							\
+			return std::format(__VA_ARGS__).size();						\
+		});																\
+		bench.run_chars(group_, "std::format_to_n", [](char* const buffer) {	\
+			return std::format_to_n(buffer, BUFFER_SIZE, __VA_ARGS__).size;	\
+		})
+#else
+	#define BENCH_STD_FORMAT(group_, ...) do {} while (false)
+#endif
+
+void
+bench_formats(
+	Bench& bench
+) {
+	bench_ceformat<all>(
+		bench, "all",
+		arg_small, arg_small_uns, arg_uns, arg_small_uns,
+		arg_float, arg_str, arg_chr
+	);
+	BENCH_SNPRINTF(
+		"all", "%% %d %u %#x %#o %f %s %c",
+		arg_small, arg_small_uns, arg_uns, arg_small_uns,
+		static_cast<double>(arg_float), arg_str, arg_chr
+	);
+	bench.run_stream("all", [](std::ostream& s) {
+		s
+			<< "% " << arg_small << ' ' << arg_small_uns << ' '
+			<< std::showbase << std::hex << arg_uns << ' '
+			<< std::oct << arg_small_uns << ' '
+			<< std::noshowbase << std::dec
+			<< std::fixed << std::setprecision(6) << arg_float << ' '
+			<< arg_str << ' ' << arg_chr
+		;
+	});
+	BENCH_STD_FORMAT(
+		"all", "% {} {} {:#x} {:#o} {:f} {} {}",
+		arg_small, arg_small_uns, arg_uns, arg_small_uns,
+		arg_float, arg_str, arg_chr
+	);
+
+	bench_ceformat<flags>(
+		bench, "flags",
+		arg_small, arg_small_uns, arg_small_uns, arg_small,
+		arg_float, arg_bool, arg_ptr, arg_ptr
+	);
+	BENCH_SNPRINTF(
+		"flags", "%+-2d %u %#x %#o %f %s %p %p",
+		arg_small, arg_small_uns, arg_small_uns,
+		static_cast<unsigned>(arg_small), static_cast<double>(arg_float),
+		arg_bool ? "true" : "false", arg_ptr, arg_ptr
+	);
+	bench.run_stream("flags", [](std::ostream& s) {
+		s
+			<< std::showpos << std::left << std::setw(2) << arg_small
+			<< std::noshowpos << ' ' << arg_small_uns << ' '
+			<< std::showbase << std::hex << arg_small_uns << ' '
+			<< std::oct << arg_small << ' '
+			<< std::dec << std::fixed << std::setprecision(6) << arg_float << ' '
+			<< std::boolalpha << arg_bool << ' '
+			<< std::internal << std::setfill('0') << std::setw(8) << arg_ptr
+			<< ' ' << arg_ptr
+		;
+	});
+	BENCH_STD_FORMAT(
+		"flags", "{:<+2} {} {:#x} {:#o} {:f} {} {:08} {}",
+		arg_small, arg_small_uns, arg_small_uns, arg_small,
+		arg_float, arg_bool, arg_ptr, arg_ptr
+	);
+
+	bench_ceformat<align>(
+		bench, "align",
+		-arg_small, arg_small_uns, arg_small, arg_small_uns,
+		-arg_float, !arg_bool, arg_ptr
+	);
+	BENCH_SNPRINTF(
+		"align", "[%-4d] [%4u] [%-#6x] [%#4o] [%07.2f] [%-10s] [%18p]",
+		-arg_small, arg_small_uns, static_cast<unsigned>(arg_small),
+		arg_small_uns, static_cast<double>(-arg_float),
+		!arg_bool ? "true" : "false", arg_ptr
+	);
+	bench.run_stream("align", [](std::ostream& s) {
+		s
+			<< '[' << std::left << std::setw(4) << -arg_small << "] ["
+			<< std::right << std::setw(4) << arg_small_uns << "] ["
+			<< std::left << std::showbase << std::hex << std::setw(6)
+			<< arg_small << "] ["
+			<< std::right << std::oct << std::setw(4) << arg_small_uns << "] ["
+			<< std::dec << std::noshowbase << std::internal << std::setfill('0')
+			<< std::fixed << std::setprecision(2) << std::setw(7) << -arg_float
+			<< "] [" << std::left << std::setfill(' ') << std::boolalpha
+			<< std::setw(10) << !arg_bool << "] ["
+			<< std::internal << std::setfill('0') << std::setw(16) << arg_ptr
+			<< ']'
+		;
+	});
+	BENCH_STD_FORMAT(
+		"align", "[{:<4}] [{:>4}] [{:<#6x}] [{:>#4o}] [{:07.2f}] [{:<10}] [{:016}]",
+		-arg_small, arg_small_uns, arg_small, arg_small_uns,
+		-arg_float, !arg_bool, arg_ptr
+	);
+
+	bench_ceformat<floats>(
+		bench, "floats",
+		arg_float, arg_float, arg_float, arg_float, arg_float, arg_float,
+		arg_float, arg_double, arg_sum,
+		arg_float, arg_float, arg_float, arg_float
+	);
+	BENCH_SNPRINTF(
+		"floats", "%f/%#f %e/%#e %g/%#g %g %g %.17g %010f %010.4f %f %.4f",
+		static_cast<double>(arg_float), static_cast<double>(arg_float),
+		static_cast<double>(arg_float), static_cast<double>(arg_float),
+		static_cast<double>(arg_float), static_cast<double>(arg_float),
+		static_cast<double>(arg_float), arg_double, arg_sum,
+		static_cast<double>(arg_float), static_cast<double>(arg_float),
+		static_cast<double>(arg_float), static_cast<double>(arg_float)
+	);
+	bench.run_stream("floats", [](std::ostream& s) {
+		s
+			<< std::fixed << arg_float << '/' << std::showpoint << arg_float
+			<< ' ' << std::noshowpoint << std::scientific << arg_float << '/'
+			<< std::showpoint << arg_float << ' ' << std::noshowpoint
+			<< std::defaultfloat << arg_float << '/' << std::showpoint
+			<< arg_float << ' ' << std::noshowpoint << arg_float << ' '
+			<< std::setprecision(17) << arg_double << ' ' << arg_sum << ' '
+			<< std::setprecision(6) << std::fixed << std::internal
+			<< std::setfill('0') << std::setw(10) << arg_float << ' '
+			<< std::setprecision(4) << std::setw(10) << arg_float << ' '
+			<< std::setprecision(6) << arg_float << ' '
+			<< std::setprecision(4) << arg_float
+		;
+	});
+	BENCH_STD_FORMAT(
+		"floats", "{:f}/{:#f} {:e}/{:#e} {}/{:#g} {} {} {} {:010f} {:010.4f} {:f} {:.4f}",
+		arg_float, arg_float, arg_float, arg_float, arg_float, arg_float,
+		arg_float, arg_double, arg_sum,
+		arg_float, arg_float, arg_float, arg_float
+	);
+}
+
+void
+bench_types(
+	Bench& bench
+) {
+	bench_ceformat<type_dec>(bench, "dec", arg_dec);
+	BENCH_SNPRINTF("dec", "%d", arg_dec);
+	bench.run_stream("dec", [](std::ostream& s) {
+		s << arg_dec;
+	});
+	BENCH_STD_FORMAT("dec", "{}", arg_dec);
+
+	bench_ceformat<type_uns>(bench, "uns", arg_uns);
+	BENCH_SNPRINTF("uns", "%u", arg_uns);
+	bench.run_stream("uns", [](std::ostream& s) {
+		s << arg_uns;
+	});
+	BENCH_STD_FORMAT("uns", "{}", arg_uns);
+
+	bench_ceformat<type_hex>(bench, "hex", arg_uns);
+	BENCH_SNPRINTF("hex", "%#x", arg_uns);
+	bench.run_stream("hex", [](std::ostream& s) {
+		s << std::showbase << std::hex << arg_uns;
+	});
+	BENCH_STD_FORMAT("hex", "{:#x}", arg_uns);
+
+	bench_ceformat<type_oct>(bench, "oct", arg_uns);
+	BENCH_SNPRINTF("oct", "%#o", arg_uns);
+	bench.run_stream("oct", [](std::ostream& s) {
+		s << std::showbase << std::oct << arg_uns;
+	});
+	BENCH_STD_FORMAT("oct", "{:#o}", arg_uns);
+
+	bench_ceformat<type_flt_f>(bench, "flt_f", arg_double);
+	BENCH_SNPRINTF("flt_f", "%f", arg_double);
+	bench.run_stream("flt_f", [](std::ostream& s) {
+		s << std::fixed << arg_double;
+	});
+	BENCH_STD_FORMAT("flt_f", "{:f}", arg_double);
+
+	bench_ceformat<type_flt_e>(bench, "flt_e", arg_double);
+	BENCH_SNPRINTF("flt_e", "%e", arg_double);
+	bench.run_stream("flt_e", [](std::ostream& s) {
+		s << std::scientific << arg_double;
+	});
+	BENCH_STD_FORMAT("flt_e", "{:e}", arg_double);
+
+	// ceformat and std::format: shortest round-trip
+	bench_ceformat<type_flt_g>(bench, "flt_g", arg_double);
+	BENCH_SNPRINTF("flt_g", "%.17g", arg_double);
+	bench.run_stream("flt_g", [](std::ostream& s) {
+		s << std::setprecision(17) << arg_double;
+	});
+	BENCH_STD_FORMAT("flt_g", "{}", arg_double);
+
+	bench_ceformat<type_str>(bench, "str", arg_str);
+	BENCH_SNPRINTF("str", "%s", arg_str);
+	bench.run_stream("str", [](std::ostream& s) {
+		s << arg_str;
+	});
+	BENCH_STD_FORMAT("str", "{}", arg_str);
+
+	bench_ceformat<type_chr>(bench, "chr", arg_chr);
+	BENCH_SNPRINTF("chr", "%c", arg_chr);
+	bench.run_stream("chr", [](std::ostream& s) {
+		s << arg_chr;
+	});
+	BENCH_STD_FORMAT("chr", "{}", arg_chr);
+
+	bench_ceformat<type_ptr>(bench, "ptr", arg_ptr);
+	BENCH_SNPRINTF("ptr", "%p", arg_ptr);
+	bench.run_stream("ptr", [](std::ostream& s) {
+		s << arg_ptr;
+	});
+	BENCH_STD_FORMAT("ptr", "{}", arg_ptr);
+
+	bench_ceformat<type_bool>(bench, "bool", arg_bool);
+	BENCH_SNPRINTF("bool", "%s", arg_bool ? "true" : "false");
+	bench.run_stream("bool", [](std::ostream& s) {
+		s << std::boolalpha << arg_bool;
+	});
+	BENCH_STD_FORMAT("bool", "{}", arg_bool);
+}
+
+double
+bytes_per_sec(
+	Result const& result
+) {
+	return 0.0 < result.p50
+		? static_cast<double>(result.bytes) * 1.0e9 / result.p50
+		: 0.0
+	;
+}
+
+void
+report_text(
+	Bench const& bench
+) {
+	std::cout
+		<< "# samples: ns/call; rate: MiB/s at p50\n"
+		<< "group      impl                        bytes        min"
+		<< "        p50        p90        p99       rate\n"
+	;
+	for (auto const& r : bench.results()) {
+		cf::write<row_text>(
+			std::cout,
+			r.group, r.impl, static_cast<unsigned>(r.bytes),
+			r.min, r.p50, r.p90, r.p99,
+			bytes_per_sec(r) / (1024.0 * 1024.0)
+		);
+	}
+}
+
+void
+report_json(
+	Bench const& bench,
+	std::size_t const samples
+) {
+	std::cout
+		<< "{\n"
+		<< "  \"samples\": " << samples << ",\n"
+		<< "  \"std_format\": " << (CEFORMAT_BENCH_STD_FORMAT ? "true" : "false") << ",\n"
+		<< "  \"results\": [\n"
+	;
+	auto const& results = bench.results();
+	for (std::size_t i = 0u; results.size() > i; ++i) {
+		Result const& r = results[i];
+		cf::write<row_json>(
+			std::cout,
+			r.group, r.impl, static_cast<unsigned>(r.bytes),
+			r.min, r.p50, r.p90, r.p99, bytes_per_sec(r)
+		);
+		std::cout << (results.size() > i + 1u ? ",\n" : "\n");
+	}
+	std::cout << "  ]\n}\n";
+}
+
+signed
+main(
+	signed argc,
+	char* argv[]
+) {
+	bool json = false;
+	std::size_t samples = 101u;
+	double sample_ns = 200000.0;
+	for (signed i = 1; argc > i; ++i) {
+		if (0 == std::strcmp(argv[i], "--json")) {
+			json = true;
+		} else if (0 == std::strcmp(argv[i], "--quick")) {
+			samples = 11u;
+			sample_ns = 20000.0;
+		} else {
+			std::cerr << "usage: " << argv[0] << " [--json] [--quick]\n";
+			return 1;
+		}
+	}
+
+	Bench bench{samples, sample_ns};
+	bench_formats(bench);
+	bench_types(bench);
+	if (json) {
+		report_json(bench, samples);
+	} else {
+		report_text(bench);
+	}
+	std::cout.flush();
+	return 0;
+}
@@ -0,0 +1,3 @@
+make_tests("bench", {
+	["bench"] = {nil, nil},
+})
@@ -43,3 +43,4 @@ precore.make_solution(
 )
 
 precore.import("general")
+precore.import("bench")
@@ -0,0 +1,254 @@
+#!/usr/bin/env bash
+#
+# Compile-time benchmark for Format construction, type checking and
+# the write instantiation chain.
+#
+# Generates translation units of FORMATS formats, each with ELEMENTS
+# elements separated by LITERAL literal characters, and compiles them
+# in each of the modes:
+#
+#   parse  Format construction only (-fsyntax-only)
+#   check  parse + detail::type_check() (-fsyntax-only)
+#   write  parse + write() and format_to() instantiations (-c)
+#
+# usage: bench.sh [report.json]
+#
+# Environment:
+#   CXX       compiler (default: c++)
+#   STD       language standard (default: c++11)
+#   OPT       optimization level for write mode (default: -O2)
+#   CXXFLAGS  extra compiler flags
+#   FORMATS   formats per translation unit (default: "10 100")
+#   ELEMENTS  elements per format (default: "0 1 4 16")
+#   LITERAL   literal characters between elements (default: "8 64")
+#   MODES     modes to run (default: "parse check write")
+#
+# Per case, the report records wall time, peak compiler RSS and, for
+# write mode, object size. Per format shape (ELEMENTS x LITERAL) it
+# records the constexpr recursion depth of a single Format and, for
+# clang, the constexpr evaluation steps. Both are found by bisecting
+# the compiler limit. GCC only counts loop iterations against
+# -fconstexpr-ops-limit, so steps are null there.
+
+set -u
+
+SCRIPT_DIR=$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)
+ROOT=$(cd "${SCRIPT_DIR}/../.." && pwd)
+
+CXX=${CXX:-c++}
+STD=${STD:-c++11}
+OPT=${OPT:--O2}
+CXXFLAGS=${CXXFLAGS:-}
+FORMATS=${FORMATS:-10 100}
+ELEMENTS=${ELEMENTS:-0 1 4 16}
+LITERAL=${LITERAL:-8 64}
+MODES=${MODES:-parse check write}
+REPORT=${1:-compile_report.json}
+
+WORK=$(mktemp -d)
+trap 'rm -rf "${WORK}"' EXIT
+
+SPECS=("%d" "%u" "%#x" "%-+12.4f" "%s" "%c" "%08.3e" "%5d")
+TYPES=("int" "unsigned" "unsigned" "double" "char const*" "char" "double" "int")
+VALUES=("1" "2u" "3u" "4.0" "\"s\"" "'c'" "5.0" "6")
+FILLER="the quick brown fox jumps over the lazy dog "
+
+if "${CXX}" --version 2>/dev/null | grep -qi clang; then
+	IS_CLANG=1
+else
+	IS_CLANG=0
+fi
+
+# literal <count> <seed>
+literal() {
+	local text=""
+	while [ ${#text} -lt "$1" ]; do
+		text+="${FILLER}"
+	done
+	text="${2}${text}"
+	printf '%s' "${text:0:$1}"
+}
+
+# format_string <index> <elements> <literal>
+format_string() {
+	local s="" k
+	for ((k = 0; k < $2; ++k)); do
+		s+="$(literal "$3" "$1.$k ")${SPECS[k % ${#SPECS[@]}]}"
+	done
+	s+="$(literal "$3" "$1 ")"
+	printf '%s' "${s}"
+}
+
+# arg_list <elements> <TYPES|VALUES>
+arg_list() {
+	local -n pool=$2
+	local s="" k
+	for ((k = 0; k < $1; ++k)); do
+		s+=", ${pool[k % ${#pool[@]}]}"
+	done
+	printf '%s' "${s}"
+}
+
+# generate <file> <mode> <formats> <elements> <literal>
+generate() {
+	local file=$1 mode=$2 n=$3 e=$4 l=$5 i types values
+	types=$(arg_list "$e" TYPES)
+	values=$(arg_list "$e" VALUES)
+	{
+		if [ "${mode}" = parse ]; then
+			echo "#include <ceformat/Format.hpp>"
+		else
+			echo "#include <ceformat/print.hpp>"
+		fi
+		for ((i = 0; i < n; ++i)); do
+			echo "static constexpr ceformat::Format const f${i}{\"$(format_string "$i" "$e" "$l")\"};"
+			case "${mode}" in
+			check)
+				echo "static_assert(ceformat::detail::type_check<f${i}${types}>(), \"\");"
+				;;
+			write)
+				echo "void w${i}(std::ostream& s, char* b) {"
+				echo "	ceformat::write<f${i}>(s${values});"
+				echo "	ceformat::format_to<f${i}>(b, b + 256${values});"
+				echo "}"
+				;;
+			esac
+		done
+	} > "${file}"
+}
+
+# elements_flag <elements>
+elements_flag() {
+	if [ "$1" -gt 16 ]; then
+		printf '%s' "-DCEFORMAT_CONFIG_ELEMENTS_MAX=$1"
+	fi
+}
+
+# compile <file> <mode> <elements> [extra flags...]
+compile() {
+	local file=$1 mode=$2 e=$3
+	shift 3
+	local out=(-fsyntax-only)
+	if [ "${mode}" = write ]; then
+		out=(-c "${OPT}" -o "${file%.cpp}.o")
+	fi
+	# shellcheck disable=SC2086
+	"${CXX}" -std="${STD}" -I"${ROOT}" -Wno-terminate ${CXXFLAGS} \
+		$(elements_flag "$e") "${out[@]}" "$@" "${file}" \
+		> /dev/null 2>&1
+}
+
+# descendants <pid>
+descendants() {
+	local p
+	for p in $(pgrep -P "$1" 2>/dev/null); do
+		echo "${p}"
+		descendants "${p}"
+	done
+}
+
+# peak_rss <pid>: poll the compiler driver and its children until exit
+PEAK_KB=0
+peak_rss() {
+	local pid=$1 p kb
+	PEAK_KB=0
+	while kill -0 "${pid}" 2>/dev/null; do
+		for p in $(descendants "${pid}"); do
+			kb=$(awk '/^VmHWM:/ { print $2 }' "/proc/${p}/status" 2>/dev/null)
+			if [ -n "${kb}" ] && [ "${kb}" -gt "${PEAK_KB}" ]; then
+				PEAK_KB=${kb}
+			fi
+		done
+		sleep 0.01
+	done
+}
+
+# measure <file> <mode> <elements>: sets WALL_MS, PEAK_KB, STATUS
+measure() {
+	local start end pid
+	start=$(date +%s%N)
+	compile "$@" &
+	pid=$!
+	peak_rss "${pid}"
+	wait "${pid}"
+	STATUS=$?
+	end=$(date +%s%N)
+	WALL_MS=$(( (end - start) / 1000000 ))
+}
+
+# bisect <file> <elements> <flag> <hi>: smallest passing limit, or null
+bisect() {
+	local file=$1 e=$2 flag=$3 lo=1 hi=$4 mid
+	if ! compile "${file}" parse "$e" "${flag}=${hi}"; then
+		printf 'null'
+		return
+	fi
+	while [ "${lo}" -lt "${hi}" ]; do
+		mid=$(( (lo + hi) / 2 ))
+		if compile "${file}" parse "$e" "${flag}=${mid}"; then
+			hi=${mid}
+		else
+			lo=$(( mid + 1 ))
+		fi
+	done
+	printf '%s' "${lo}"
+}
+
+json_string() {
+	local s=${1//\\/\\\\}
+	printf '"%s"' "${s//\"/\\\"}"
+}
+
+declare -A DEPTH STEPS
+cases=()
+
+for e in ${ELEMENTS}; do
+	for l in ${LITERAL}; do
+		file="${WORK}/shape_${e}_${l}.cpp"
+		generate "${file}" parse 1 "$e" "$l"
+		DEPTH[$e.$l]=$(bisect "${file}" "$e" -fconstexpr-depth 65536)
+		if [ "${IS_CLANG}" = 1 ]; then
+			STEPS[$e.$l]=$(bisect "${file}" "$e" -fconstexpr-steps 268435456)
+		else
+			STEPS[$e.$l]=null
+		fi
+		for n in ${FORMATS}; do
+			for mode in ${MODES}; do
+				file="${WORK}/${mode}_${n}_${e}_${l}.cpp"
+				generate "${file}" "${mode}" "$n" "$e" "$l"
+				measure "${file}" "${mode}" "$e"
+				object=null
+				text=null
+				if [ "${mode}" = write ] && [ "${STATUS}" = 0 ]; then
+					object=$(stat -c %s "${file%.cpp}.o")
+					text=$(size "${file%.cpp}.o" 2>/dev/null | awk 'NR == 2 { print $1 }')
+					text=${text:-null}
+				fi
+				printf '%-5s formats=%-5s elements=%-3s literal=%-4s %7s ms %8s KiB%s\n' \
+					"${mode}" "$n" "$e" "$l" "${WALL_MS}" "${PEAK_KB}" \
+					"$([ "${STATUS}" = 0 ] || echo ' FAILED')" >&2
+				cases+=("$(printf '{"mode": "%s", "formats": %s, "elements": %s, "literal": %s, "ok": %s, "wall_ms": %s, "peak_rss_kib": %s, "object_bytes": %s, "text_bytes": %s, "constexpr_depth": %s, "constexpr_steps": %s}' \
+					"${mode}" "$n" "$e" "$l" \
+					"$([ "${STATUS}" = 0 ] && echo true || echo false)" \
+					"${WALL_MS}" "${PEAK_KB}" "${object}" "${text}" \
+					"${DEPTH[$e.$l]}" "${STEPS[$e.$l]}")")
+			done
+		done
+	done
+done
+
+{
+	printf '{\n'
+	printf '\t"compiler": %s,\n' "$(json_string "$("${CXX}" --version | head -n 1)")"
+	printf '\t"std": %s,\n' "$(json_string "${STD}")"
+	printf '\t"opt": %s,\n' "$(json_string "${OPT}")"
+	printf '\t"cxxflags": %s,\n' "$(json_string "${CXXFLAGS}")"
+	printf '\t"cases": [\n'
+	for ((i = 0; i < ${#cases[@]}; ++i)); do
+		printf '\t\t%s%s\n' "${cases[i]}" "$([ $((i + 1)) -lt ${#cases[@]} ] && echo ,)"
+	done
+	printf '\t]\n'
+	printf '}\n'
+} > "${REPORT}"
+
+echo "report: ${REPORT}" >&2
@@ -2,8 +2,22 @@
 #include <ceformat/Format.hpp>
 #include <ceformat/format_debug.hpp>
 #include <ceformat/print.hpp>
+#include <ceformat/DynamicFormat.hpp>
+#include <ceformat/defer.hpp>
+#include <ceformat/binary.hpp>
+#include <ceformat/sink.hpp>
+#include <ceformat/iovec.hpp>
+#include <ceformat/ring.hpp>
+#include <ceformat/atomic.hpp>
+#include <ceformat/fixed.hpp>
 
 #include <iostream>
+#include <sstream>
+#include <vector>
+
+#if CEFORMAT_CONFIG_IOVEC
+	#include <unistd.h>
+#endif
 
 static constexpr ceformat::Format const
 	//bad_length{"%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%"},
@@ -20,7 +34,10 @@ static constexpr ceformat::Format const
 	obj{"%s"},
 	empty{"empty"},
 	null{""},
-	floats{"%f/%#f %e/%#e %g/%#g %g %g %010f %010.4f %f %.4f"}
+	floats{"%f/%#f %e/%#e %g/%#g %g %g %010f %010.4f %f %.4f"},
+	shortest{"%g %g %g %g"},
+	obj_hex{"%#x %s"},
+	obj_sign{"%+d %s"}
 ;
 
 #define SNOTE(n__) std::cout << "Tracked(" n__ ")\n";
@@ -40,6 +57,19 @@ operator<<(
 	return stream << "<< Tracked";
 }
 
+// Object whose output depends on stream state
+struct Numeric final {
+	signed value;
+};
+
+std::ostream&
+operator<<(
+	std::ostream& stream,
+	Numeric const& numeric
+) {
+	return stream << numeric.value << ' ' << 1.5 << ' ' << true;
+}
+
 namespace cf = ceformat;
 
 char const
@@ -83,6 +113,10 @@ main() {
 		<< "\nwith sentinel:\n\n"
 		CEFORMAT_TEST_IO(write_sentinel)
 	;
+	// NB: Each view is invalidated by the next call
+	std::cout << "\nwith print_view:\n\n";
+	std::cout << cf::print_view<align>(-42, 42u, 42, 42u, -42.0f, false, ep) << '\n';
+	std::cout << cf::print_view<obj>(cf::StringView(strlit_solid, 6u)) << '\n';
 
 	std::cout << "\nwith write:\n\n";
 	cf::write<all>(std::cout, -3, 42u, 0x12abcdef, 0777, 3.14f, "string", 'A');
@@ -97,5 +131,153 @@ main() {
 		3.14f, 3.14f, 3.14f, 3.14f
 	);
 	std::cout << '\n';
+	// Grisu2 would yield 17 digits for the second
+	cf::write<shortest>(std::cout, 0.1 + 0.2, 5.329070518200751e-15, 1e23, 3.14f);
+	std::cout << '\n';
+	cf::write<obj_hex>(std::cout, 255, Numeric{10});
+	std::cout << '\n';
+	cf::write<obj_sign>(std::cout, 5, Numeric{10});
+	std::cout << '\n';
+
+	std::cout << "\nwith format_to:\n\n";
+	char buffer[128u];
+	cf::FormatToResult const result = cf::format_to<align>(
+		buffer, buffer + sizeof(buffer),
+		-42, 42u, 42, 42u, -42.0f, false, ep
+	);
+	std::cout.write(buffer, result.out - buffer);
+	std::cout << " (" << result.size << ")\n";
+	cf::FormatToResult const truncated = cf::format_to_n<all>(
+		buffer, 8u,
+		-3, 42u, 0x12abcdef, 0777, 3.14f, "string", 'A'
+	);
+	std::cout.write(buffer, truncated.out - buffer);
+	std::cout << " (" << truncated.size << ")\n";
+	std::cout
+		<< "formatted_size: "
+		<< cf::formatted_size<all>(-3, 42u, 0x12abcdef, 0777, 3.14f, "string", 'A')
+		<< '\n'
+	;
+
+	std::cout << "\nwith print_to:\n\n";
+	cf::String line;
+	for (signed index = 0; 3 > index; ++index) {
+		line.clear();
+		cf::print_to<obj>(line, "[");
+		cf::print_to<flags>(line, index, 42u, 42u, 42, 42.0f, true, ep, nullptr);
+		cf::print_to<obj>(line, concrete);
+		std::cout << line << "]\n";
+	}
+	std::cout << "\nwith DynamicFormat:\n\n";
+	cf::DynamicFormat const& dynamic = cf::DynamicFormat::cached(align.string);
+	cf::write(std::cout, dynamic, -42, 42u, 42, 42u, -42.0f, false, ep);
+	std::cout << '\n' << cf::print(
+		cf::DynamicFormat::cached("%s has %d elements"),
+		dynamic.string, static_cast<unsigned>(dynamic.element_count)
+	) << '\n';
+	try {
+		cf::DynamicFormat const bad{"%+x"};
+	} catch (std::logic_error const& e) {
+		std::cout << "%+x: " << e.what() << '\n';
+	}
+
+	std::cout << "\nwith defer:\n\n";
+	cf::DeferQueue<4u, cf::DeferPolicy::count> queue;
+	cf::defer<obj>(queue, cf::defer_ref(concrete));
+	// The last two are discarded
+	for (signed index = 0; 5 > index; ++index) {
+		cf::defer<all>(queue, index, 42u, 0x12abcdef, 0777, 3.14f, strlit_solid, 'A');
+	}
+	queue.drain([](cf::StringView const line) {
+		std::cout << line << '\n';
+	});
+	std::cout << "overflow: " << queue.overflow_count() << '\n';
+	// Strings are truncated to fit the 16-byte payload
+	cf::DeferQueue<2u, cf::DeferPolicy::drop, 16u> small_queue;
+	cf::defer<obj>(small_queue, "longer than the record payload");
+	small_queue.drain([](cf::StringView const line) {
+		std::cout << line << '\n';
+	});
+	std::cout << "truncated: " << small_queue.truncated_count() << '\n';
+
+	std::cout << "\nwith sinks:\n\n";
+	std::vector<char> vec;
+	cf::VectorSink vec_sink{vec};
+	cf::write<all>(vec_sink, 1, 42u, 0x12abcdef, 0777, 3.14f, strlit_solid, 'A');
+	cf::write(vec_sink, cf::DynamicFormat::cached(all.string), 2, 42u, 0x12abcdef, 0777, 3.14f, strlit_solid, 'A');
+	std::cout.write(vec.data(), static_cast<std::streamsize>(vec.size())) << '\n';
+	char array[16];
+	cf::BufferSink array_sink = cf::array_sink(array);
+	cf::write<all>(array_sink, 3, 42u, 0x12abcdef, 0777, 3.14f, strlit_solid, 'A');
+	std::cout << cf::StringView(array, static_cast<std::size_t>(array_sink.pos - array)) << '\n';
+	cf::CountingSink counting_sink{0u};
+	cf::write<all>(counting_sink, 4, 42u, 0x12abcdef, 0777, 3.14f, strlit_solid, 'A');
+	std::cout << array_sink.size << ' ' << counting_sink.size << '\n';
+	cf::StreamSink stream_sink{std::cout};
+	cf::write<obj>(stream_sink, concrete);
+	std::cout << '\n';
+
+#if CEFORMAT_CONFIG_IOVEC
+	std::cout << "\nwith writev:\n\n";
+	std::cout.flush();
+	cf::write_fd<all>(STDOUT_FILENO, 5, 42u, 0x12abcdef, 0777, 3.14f, strlit_solid, 'A');
+	cf::write_fd<obj>(STDOUT_FILENO, "\n");
+#endif
+
+	std::cout << "\nwith ring:\n\n";
+	// The last three are dropped
+	static cf::RecordRing<128u> ring;
+	for (signed index = 0; 5 > index; ++index) {
+		cf::write_record<all>(ring, index, 42u, 0x12abcdef, 0777, 3.14f, strlit_solid, '\n');
+	}
+	cf::String drained;
+	cf::StringSink ring_sink{drained};
+	std::size_t const drained_count = ring.drain(ring_sink);
+	std::cout << drained;
+	std::cout << "drained: " << drained_count << '\n';
+	std::cout << "dropped: " << ring.dropped_count() << '\n';
+
+	std::cout << "\nwith write_atomic:\n\n";
+	cf::write_atomic<all>(std::cout, 6, 42u, 0x12abcdef, 0777, 3.14f, strlit_solid, '\n');
+	cf::write_atomic<obj>(std::cout, concrete);
+	std::cout << '\n';
+
+	std::cout << "\nwith print_fixed:\n\n";
+	auto const fixed = cf::print_fixed<align>(-1, 2u, 3u, 4u, 5.0, true, &concrete);
+	std::cout << fixed << '\n';
+	std::cout << "size: " << fixed.size() << " of " << fixed.capacity << '\n';
+	std::cout
+		<< "bound: "
+		<< cf::max_output_size<flags, signed, unsigned, unsigned, unsigned, float, bool, void*, std::nullptr_t>()
+		<< '\n'
+	;
+
+#if CEFORMAT_CONFIG_PMR
+	std::cout << "\nwith std::pmr:\n\n";
+	char arena_buffer[256];
+	std::pmr::monotonic_buffer_resource arena{
+		arena_buffer, sizeof(arena_buffer), std::pmr::null_memory_resource()
+	};
+	std::cout << cf::print<all>(arena, 7, 42u, 0x12abcdef, 0777, 3.14f, strlit_solid, 'A') << '\n';
+#endif
+
+	std::cout << "\nwith binary:\n\n";
+	cf::String records;
+	cf::encode_to<all>(records, -1, 42u, 0x12abcdef, 0777, 3.14f, strlit_solid, 'A');
+	cf::encode_to<align>(records, 1, 2u, 3u, 4u, 5.0, false, &concrete);
+	cf::encode_to<obj>(records, concrete);
+	std::stringstream manifest_stream;
+	cf::write_manifest(manifest_stream);
+	cf::BinaryManifest manifest;
+	cf::read_manifest(manifest_stream, manifest);
+	std::cout << "records: " << records.size() << " bytes\n";
+	char const* pos = records.data();
+	cf::String decoded;
+	while (cf::DecodeStatus::ok == cf::decode_to(
+		decoded, manifest, pos, records.data() + records.size()
+	)) {
+		std::cout << decoded << '\n';
+		decoded.clear();
+	}
 	std::cout.flush();
 }
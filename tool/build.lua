@@ -0,0 +1,28 @@
+
+local S, G, P = precore.helpers()
+
+precore.make_solution(
+	"tool",
+	{"debug", "release"},
+	{"x64", "x32"},
+	nil,
+	{
+		"precore.generic",
+	}
+)
+
+precore.make_project(
+	"tool_decode",
+	"C++", "ConsoleApp",
+	"./", "out/",
+	nil, {"ceformat.strict", "ceformat.dep"}
+)
+
+configuration {"linux"}
+	targetsuffix(".elf")
+
+configuration {}
+	targetname("ceformat-decode")
+	files {
+		"decode.cpp"
+	}
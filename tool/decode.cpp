@@ -0,0 +1,104 @@
+#include <ceformat/Format.hpp>
+#include <ceformat/print.hpp>
+#include <ceformat/binary.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace cf = ceformat;
+
+static constexpr cf::Format const
+	usage{"usage: %s [-n] <manifest> [<records>|-]\n"},
+	error_open{"%s: cannot open %s\n"},
+	error_manifest{"%s: malformed manifest line in %s\n"},
+	error_record{"%s: %s record at offset %u\n"}
+;
+
+static char const*
+status_name(
+	cf::DecodeStatus const status
+) noexcept {
+	switch (status) {
+	case cf::DecodeStatus::ok: return "ok";
+	case cf::DecodeStatus::end: return "end";
+	case cf::DecodeStatus::unknown_format: return "unknown format of";
+	case cf::DecodeStatus::malformed: return "malformed";
+	}
+	return "invalid";
+}
+
+signed
+main(
+	signed argc,
+	char* argv[]
+) {
+	bool newline = false;
+	signed arg = 1;
+	if (argc > arg && 0 == std::strcmp(argv[arg], "-n")) {
+		newline = true;
+		++arg;
+	}
+	if (argc <= arg || argc > arg + 2) {
+		cf::write<usage>(std::cerr, argv[0]);
+		return 2;
+	}
+
+	cf::BinaryManifest manifest;
+	std::ifstream manifest_stream{argv[arg]};
+	if (!manifest_stream) {
+		cf::write<error_open>(std::cerr, argv[0], argv[arg]);
+		return 1;
+	}
+	try {
+		if (!cf::read_manifest(manifest_stream, manifest)) {
+			cf::write<error_manifest>(std::cerr, argv[0], argv[arg]);
+			return 1;
+		}
+	} catch (std::logic_error const& e) {
+		std::cerr << argv[0] << ": " << argv[arg] << ": " << e.what() << '\n';
+		return 1;
+	}
+
+	std::string records;
+	if (argc == arg + 1 || 0 == std::strcmp(argv[arg + 1], "-")) {
+		records.assign(
+			std::istreambuf_iterator<char>{std::cin},
+			std::istreambuf_iterator<char>{}
+		);
+	} else {
+		std::ifstream records_stream{argv[arg + 1], std::ios_base::binary};
+		if (!records_stream) {
+			cf::write<error_open>(std::cerr, argv[0], argv[arg + 1]);
+			return 1;
+		}
+		records.assign(
+			std::istreambuf_iterator<char>{records_stream},
+			std::istreambuf_iterator<char>{}
+		);
+	}
+
+	char const* pos = records.data();
+	char const* const end = records.data() + records.size();
+	cf::DecodeStatus status;
+	std::string text;
+	while (cf::DecodeStatus::ok == (status = cf::decode_to(text, manifest, pos, end))) {
+		if (newline) {
+			text.push_back('\n');
+		}
+		std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+		text.clear();
+	}
+	std::cout.flush();
+	if (cf::DecodeStatus::end != status) {
+		cf::write<error_record>(
+			std::cerr, argv[0], status_name(status),
+			static_cast<unsigned long long>(pos - records.data())
+		);
+		return 1;
+	}
+	return 0;
+}